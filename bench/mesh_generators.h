@@ -0,0 +1,149 @@
+//
+// Created by RainSure on 24-10-15.
+//
+
+#ifndef MESH_INTERSECTION_MESH_GENERATORS_H
+#define MESH_INTERSECTION_MESH_GENERATORS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "examples/mesh_data.h"
+
+/**
+ * 基准测试用的参数化网格。所有网格先生成共享的顶点数组再按下标组成三角形，
+ * 相同的顶点坐标完全一致，焊接后得到索引网格；封闭网格的法向朝外。
+ */
+
+constexpr double kBenchPi = 3.14159265358979323846;
+
+inline void append_triangles(const std::vector<Point3D>& points, const std::vector<std::array<std::size_t, 3>>& faces,
+                             std::vector<Triangle3D>& triangles) {
+    triangles.reserve(triangles.size() + faces.size());
+    for (const auto& face : faces) {
+        triangles.emplace_back(points[face[0]], points[face[1]], points[face[2]]);
+    }
+}
+
+// 顶端点 top、若干圈 rings[k] (每圈 segments 个点) 与底端点 bottom 组成的封闭网格 (球、圆锥)
+inline std::vector<Triangle3D> make_closed_rings(const Point3D& top, const std::vector<std::vector<Point3D>>& rings, const Point3D& bottom) {
+    const std::size_t segments = rings.front().size();
+    std::vector<Point3D> points;
+    points.push_back(top);
+    for (const auto& ring : rings) {
+        points.insert(points.end(), ring.begin(), ring.end());
+    }
+    points.push_back(bottom);
+    auto ring_point = [segments](std::size_t k, std::size_t j) { return 1 + k * segments + j % segments; };
+
+    std::vector<std::array<std::size_t, 3>> faces;
+    faces.reserve(2 * segments * rings.size());
+    for (std::size_t j = 0; j < segments; ++j) {
+        faces.push_back({0, ring_point(0, j), ring_point(0, j + 1)});
+    }
+    for (std::size_t k = 0; k + 1 < rings.size(); ++k) {
+        for (std::size_t j = 0; j < segments; ++j) {
+            const std::size_t a = ring_point(k, j), b = ring_point(k, j + 1);
+            const std::size_t c = ring_point(k + 1, j), d = ring_point(k + 1, j + 1);
+            faces.push_back({a, c, d});
+            faces.push_back({a, d, b});
+        }
+    }
+    const std::size_t last = rings.size() - 1;
+    for (std::size_t j = 0; j < segments; ++j) {
+        faces.push_back({points.size() - 1, ring_point(last, j + 1), ring_point(last, j)});
+    }
+
+    std::vector<Triangle3D> triangles;
+    append_triangles(points, faces, triangles);
+    return triangles;
+}
+
+// 经纬球，面数约为 target_faces
+inline std::vector<Triangle3D> make_sphere(const Point3D& center, double radius, std::size_t target_faces) {
+    const std::size_t rings = std::max<std::size_t>(3, static_cast<std::size_t>(std::lround(std::sqrt(target_faces / 4.0))));
+    const std::size_t segments = 2 * rings;
+    std::vector<std::vector<Point3D>> circles(rings - 1);
+    for (std::size_t i = 1; i < rings; ++i) {
+        const double theta = kBenchPi * static_cast<double>(i) / static_cast<double>(rings);
+        for (std::size_t j = 0; j < segments; ++j) {
+            const double phi = 2.0 * kBenchPi * static_cast<double>(j) / static_cast<double>(segments);
+            circles[i - 1].emplace_back(center.x + radius * std::sin(theta) * std::cos(phi),
+                                        center.y + radius * std::sin(theta) * std::sin(phi),
+                                        center.z + radius * std::cos(theta));
+        }
+    }
+    return make_closed_rings({center.x, center.y, center.z + radius}, circles, {center.x, center.y, center.z - radius});
+}
+
+// 带底面的封闭圆锥，底面圆心 base_center 位于 z 平面内，面数约为 target_faces
+inline std::vector<Triangle3D> make_cone(const Point3D& base_center, double radius, double height, std::size_t target_faces) {
+    const std::size_t bands = std::max<std::size_t>(2, static_cast<std::size_t>(std::lround(std::sqrt(target_faces / 4.0))));
+    const std::size_t segments = 2 * bands;
+    const Point3D apex(base_center.x, base_center.y, base_center.z + height);
+    std::vector<std::vector<Point3D>> circles(bands);
+    for (std::size_t k = 1; k <= bands; ++k) {
+        const double t = static_cast<double>(k) / static_cast<double>(bands);
+        for (std::size_t j = 0; j < segments; ++j) {
+            const double phi = 2.0 * kBenchPi * static_cast<double>(j) / static_cast<double>(segments);
+            circles[k - 1].emplace_back(apex.x + t * radius * std::cos(phi),
+                                        apex.y + t * radius * std::sin(phi),
+                                        apex.z - t * height);
+        }
+    }
+    return make_closed_rings(apex, circles, base_center);
+}
+
+/**
+ * [-half_size, half_size]^2 上的高度场网格，面数约为 target_faces。
+ * height(x, y) 给出高度，noise > 0 时叠加固定种子的均匀噪声。
+ */
+template <class Height>
+std::vector<Triangle3D> make_height_field(double half_size, std::size_t target_faces, Height&& height, double noise = 0.0,
+                                          std::uint32_t seed = 42) {
+    const std::size_t n = std::max<std::size_t>(1, static_cast<std::size_t>(std::lround(std::sqrt(target_faces / 2.0))));
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> jitter(-noise, noise);
+
+    std::vector<Point3D> points;
+    points.reserve((n + 1) * (n + 1));
+    for (std::size_t i = 0; i <= n; ++i) {
+        for (std::size_t j = 0; j <= n; ++j) {
+            const double x = -half_size + 2.0 * half_size * static_cast<double>(j) / static_cast<double>(n);
+            const double y = -half_size + 2.0 * half_size * static_cast<double>(i) / static_cast<double>(n);
+            points.emplace_back(x, y, height(x, y) + (noise > 0.0 ? jitter(rng) : 0.0));
+        }
+    }
+
+    std::vector<std::array<std::size_t, 3>> faces;
+    faces.reserve(2 * n * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            const std::size_t v00 = i * (n + 1) + j, v01 = v00 + 1;
+            const std::size_t v10 = v00 + (n + 1), v11 = v10 + 1;
+            faces.push_back({v00, v01, v11});
+            faces.push_back({v00, v11, v10});
+        }
+    }
+
+    std::vector<Triangle3D> triangles;
+    append_triangles(points, faces, triangles);
+    return triangles;
+}
+
+// 略微倾斜的平面，避免与其他网格的顶点恰好共面
+inline std::vector<Triangle3D> make_plane(double half_size, std::size_t target_faces) {
+    return make_height_field(half_size, target_faces, [](double x, double y) { return 0.013 + 0.011 * x + 0.007 * y; });
+}
+
+// 起伏的地形，叠加噪声
+inline std::vector<Triangle3D> make_terrain(double half_size, std::size_t target_faces, double noise = 0.01) {
+    return make_height_field(half_size, target_faces,
+                             [](double x, double y) { return 0.15 * std::sin(2.1 * x) * std::cos(1.7 * y) + 0.017; }, noise);
+}
+
+#endif //MESH_INTERSECTION_MESH_GENERATORS_H
@@ -0,0 +1,435 @@
+//
+// Created by RainSure on 24-10-15.
+//
+
+#include <CGAL/version.h>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "examples/binary_mesh_io.h"
+#include "examples/co_refinement.h"
+#include "examples/intersection_line.h"
+#include "examples/mesh_intersection.h"
+#include "examples/multi_clip.h"
+#include "mesh_generators.h"
+
+#ifndef MESH_INTERSECTION_DATA_DIR
+#define MESH_INTERSECTION_DATA_DIR "data"
+#endif
+
+/**
+ * 基准测试:
+ * mesh_intersection_bench [--repetitions=N] [--min-faces=N] [--max-faces=N] [--filter=S] [--data-dir=DIR] [--output=FILE]
+ *
+ * 对 ClipMesh、co_refinement、mesh_intersection 与 intersection_line 的各个阶段 (读取、构造网格、共精细化、
+ * 点定位、删除面、输出等) 分别计时。合成网格 (球、平面、圆锥、带噪声的地形) 的面数从 1k 到 1M，
+ * 另外使用 data 目录下的 PLY 文件。结果写入 JSON 文件 (默认 mesh_intersection_bench.json)，便于回归比较。
+ */
+
+struct BenchConfig {
+    int repetitions = 3;
+    std::size_t min_faces = 1000;
+    std::size_t max_faces = 1000000;
+    // 只运行名称包含 filter 的用例
+    std::string filter;
+    std::string data_dir = MESH_INTERSECTION_DATA_DIR;
+    std::string output = "mesh_intersection_bench.json";
+    std::filesystem::path work_dir;
+};
+
+// 每个阶段每次重复的耗时 (毫秒)，按阶段首次出现的顺序保存
+class StageTimes {
+public:
+    template <class Function>
+    void time(const std::string& stage, Function&& function) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto end = std::chrono::steady_clock::now();
+        samples(stage).push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    const std::vector<std::pair<std::string, std::vector<double>>>& stages() const { return stages_; }
+
+private:
+    std::vector<double>& samples(const std::string& stage) {
+        for (auto& entry : stages_) {
+            if (entry.first == stage) return entry.second;
+        }
+        stages_.emplace_back(stage, std::vector<double>());
+        return stages_.back().second;
+    }
+
+    std::vector<std::pair<std::string, std::vector<double>>> stages_;
+};
+
+struct BenchResult {
+    std::string name;
+    std::size_t mesh1_faces = 0;
+    std::size_t mesh2_faces = 0;
+    StageTimes times;
+    // 最后一次重复的计数，如共精细化后的面数、删除的面数
+    std::vector<std::pair<std::string, std::size_t>> counters;
+};
+
+// 以 ReadMeshData 的输入格式写出，坐标使用可以精确还原的最短表示
+inline void write_clip_input(const std::string& file_path, const std::vector<Triangle3D>& mesh1, const std::vector<Triangle3D>& mesh2) {
+    std::ofstream outfile(file_path, std::ios::binary);
+    std::string buffer;
+    auto append = [&buffer](double value) {
+        char digits[32];
+        buffer.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+    };
+    const std::vector<Triangle3D>* meshes[2] = {&mesh1, &mesh2};
+    for (int m = 0; m < 2; ++m) {
+        buffer += m == 0 ? "mesh1\n" : "mesh2\n";
+        for (const auto& triangle : *meshes[m]) {
+            for (const auto& p : triangle.points) {
+                append(p.x);
+                buffer += ' ';
+                append(p.y);
+                buffer += ' ';
+                append(p.z);
+                buffer += '\n';
+            }
+        }
+    }
+    outfile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+inline Mesh make_mesh(const std::vector<Triangle3D>& triangles) {
+    Mesh mesh;
+    BuildMesh(triangles, mesh);
+    return mesh;
+}
+
+// ClipMesh 在内核 Kernel 下的各个阶段，结果名为 prefix + name
+template <class Kernel>
+BenchResult bench_clip(const std::string& prefix, const std::string& name, const std::vector<Triangle3D>& cutter,
+                       const std::vector<Triangle3D>& target, const BenchConfig& config) {
+    BenchResult result;
+    result.name = prefix + name;
+    result.mesh1_faces = cutter.size();
+    result.mesh2_faces = target.size();
+    const std::string input = (config.work_dir / "clip_input.txt").string();
+    const std::string output = (config.work_dir / "clip_output.txt").string();
+    write_clip_input(input, cutter, target);
+
+    for (int r = 0; r < config.repetitions; ++r) {
+        MeshData mesh1, mesh2;
+        Kernel_mesh<Kernel> cgal_mesh1, cgal_mesh2;
+        std::size_t removed_faces = 0;
+        std::vector<CGAL::Point_3<Kernel>> points_in_boundary;
+        result.times.time("parse", [&]() { ReadMeshData(input, mesh1, mesh2); });
+        result.times.time("mesh_build", [&]() {
+            BuildMesh(mesh1.triangles, cgal_mesh1);
+            BuildMesh(mesh2.triangles, cgal_mesh2);
+        });
+        auto constrained = cgal_mesh2.template add_property_map<Edge_index, bool>("e:constrained", false).first;
+        result.times.time("corefine", [&]() { corefine_meshes(cgal_mesh1, cgal_mesh2, false, &constrained); });
+        const std::size_t corefined_faces = cgal_mesh2.number_of_faces();
+        result.times.time("boundary", [&]() { boundary_polylines(cgal_mesh2, constrained, points_in_boundary); });
+        Kernel_face_label_map<Kernel> inside;
+        result.times.time("classification", [&]() {
+            Kernel_face_tree<Kernel> tree(faces(cgal_mesh1).first, faces(cgal_mesh1).second, cgal_mesh1);
+            tree.build();
+            inside = classify_patches(cgal_mesh2, tree, constrained);
+        });
+        cgal_mesh2.remove_property_map(constrained);
+        result.times.time("face_removal", [&]() { removed_faces = remove_labeled_faces(cgal_mesh2, inside); });
+        result.times.time("output", [&]() {
+            std::vector<Point3D> boundary_points;
+            for (const auto& point : points_in_boundary) {
+                boundary_points.push_back(to_point3d(point));
+            }
+            MeshToTriangles(cgal_mesh1, mesh1.triangles);
+            MeshToTriangles(cgal_mesh2, mesh2.triangles);
+            WriteMeshData(output, mesh1, mesh2, boundary_points);
+        });
+        result.counters = {{"faces_after_corefine", corefined_faces},
+                           {"faces_removed", removed_faces},
+                           {"boundary_points", points_in_boundary.size()}};
+    }
+    return result;
+}
+
+// co_refinement 的各个阶段，输入以 OFF 文件读取
+inline BenchResult bench_co_refinement(const std::string& name, const Mesh& mesh1, const Mesh& mesh2, const BenchConfig& config) {
+    BenchResult result;
+    result.name = "co_refinement/" + name;
+    result.mesh1_faces = mesh1.number_of_faces();
+    result.mesh2_faces = mesh2.number_of_faces();
+    const std::string input1 = (config.work_dir / "co_refinement_input1.off").string();
+    const std::string input2 = (config.work_dir / "co_refinement_input2.off").string();
+    CGAL::IO::write_polygon_mesh(input1, mesh1, CGAL::parameters::stream_precision(17));
+    CGAL::IO::write_polygon_mesh(input2, mesh2, CGAL::parameters::stream_precision(17));
+
+    for (int r = 0; r < config.repetitions; ++r) {
+        Mesh copy1, copy2;
+        result.times.time("parse", [&]() {
+            PMP::IO::read_polygon_mesh(input1, copy1);
+            PMP::IO::read_polygon_mesh(input2, copy2);
+        });
+        result.times.time("corefine", [&]() { PMP::corefine(copy1, copy2); });
+        result.times.time("output", [&]() {
+            CGAL::IO::write_polygon_mesh((config.work_dir / "co_refinement_output1.off").string(), copy1, CGAL::parameters::stream_precision(17));
+            CGAL::IO::write_polygon_mesh((config.work_dir / "co_refinement_output2.off").string(), copy2, CGAL::parameters::stream_precision(17));
+        });
+        result.counters = {{"mesh1_faces_after_corefine", copy1.number_of_faces()},
+                           {"mesh2_faces_after_corefine", copy2.number_of_faces()}};
+    }
+    return result;
+}
+
+// 多个裁剪体: 依次调用 ClipMesh 与一次 ClipMeshMulti 的对照
+inline BenchResult bench_multi_clip(const std::string& name, const std::vector<std::vector<Triangle3D>>& cutters,
+                                    const std::vector<Triangle3D>& target, const BenchConfig& config) {
+    BenchResult result;
+    result.name = "multi_clip/" + name;
+    for (const auto& cutter : cutters) {
+        result.mesh1_faces += cutter.size();
+    }
+    result.mesh2_faces = target.size();
+
+    for (int r = 0; r < config.repetitions; ++r) {
+        std::vector<Triangle3D> sequential = target;
+        std::size_t sequential_points = 0;
+        result.times.time("sequential_clip", [&]() {
+            for (const auto& cutter : cutters) {
+                std::vector<Triangle3D> refined = cutter;
+                sequential_points += ClipMesh(refined, sequential).size();
+            }
+        });
+        std::vector<std::vector<Triangle3D>> refined = cutters;
+        std::vector<Triangle3D> clipped = target;
+        std::vector<std::vector<Point3D>> boundary_points;
+        result.times.time("multi_clip", [&]() { ClipMeshMulti(refined, clipped, boundary_points); });
+        std::size_t multi_points = 0;
+        for (const auto& points : boundary_points) {
+            multi_points += points.size();
+        }
+        result.counters = {{"cutters", cutters.size()},
+                           {"faces_sequential", sequential.size()},
+                           {"faces_multi", clipped.size()},
+                           {"boundary_points_sequential", sequential_points},
+                           {"boundary_points_multi", multi_points}};
+    }
+    return result;
+}
+
+// mesh_intersection (交集与并集)，两个网格都必须封闭
+inline BenchResult bench_boolean(const std::string& name, const Mesh& mesh1, const Mesh& mesh2, const BenchConfig& config) {
+    BenchResult result;
+    result.name = "mesh_intersection/" + name;
+    result.mesh1_faces = mesh1.number_of_faces();
+    result.mesh2_faces = mesh2.number_of_faces();
+    const std::string output_intersection = (config.work_dir / "boolean_intersection.off").string();
+    const std::string output_union = (config.work_dir / "boolean_union.off").string();
+
+    for (int r = 0; r < config.repetitions; ++r) {
+        Mesh copy1, copy2;
+        result.times.time("mesh_build", [&]() {
+            copy1 = mesh1;
+            copy2 = mesh2;
+        });
+        // 包含共精细化、交集与并集的计算以及结果输出
+        result.times.time("boolean", [&]() { mesh_intersection(copy1, copy2, output_intersection, output_union); });
+    }
+    return result;
+}
+
+// intersection_line 的各个阶段，输入以二进制 PLY 文件读取
+inline BenchResult bench_intersection_line(const std::string& name, const Mesh& mesh1, const Mesh& mesh2, const BenchConfig& config) {
+    BenchResult result;
+    result.name = "intersection_line/" + name;
+    result.mesh1_faces = mesh1.number_of_faces();
+    result.mesh2_faces = mesh2.number_of_faces();
+    const std::string input1 = (config.work_dir / "intersection_line_input1.ply").string();
+    const std::string input2 = (config.work_dir / "intersection_line_input2.ply").string();
+    const std::string output = (config.work_dir / "intersection_line_output.ply").string();
+    CGAL::IO::write_polygon_mesh(input1, mesh1, CGAL::parameters::use_binary_mode(true));
+    CGAL::IO::write_polygon_mesh(input2, mesh2, CGAL::parameters::use_binary_mode(true));
+
+    for (int r = 0; r < config.repetitions; ++r) {
+        Mesh copy1, copy2;
+        std::vector<std::pair<Face_index, Face_index>> pairs;
+        std::vector<Segment_3> segments;
+        result.times.time("parse", [&]() {
+            read_ply_mesh(input1, copy1);
+            read_ply_mesh(input2, copy2);
+        });
+        result.times.time("broad_phase", [&]() { pairs = candidate_face_pairs(copy1, copy2); });
+        result.times.time("exact_intersection", [&]() {
+            for (const auto& pair : pairs) {
+                intersect_triangles(face_triangle(copy1, pair.first), face_triangle(copy2, pair.second), segments);
+            }
+        });
+        // 分离轴预筛选 (含收集顶点坐标)，以及只对筛选后剩下的面对做精确求交
+        std::vector<std::uint8_t> keep(pairs.size(), 1);
+        result.times.time("prefilter", [&]() {
+            const TriangleSoA triangles1 = mesh_triangle_soa(copy1), triangles2 = mesh_triangle_soa(copy2);
+            TrianglePairBatch batch;
+            for (std::size_t begin = 0; begin < pairs.size(); begin += TrianglePairBatch::capacity) {
+                const std::size_t count = std::min(TrianglePairBatch::capacity, pairs.size() - begin);
+                for (std::size_t j = 0; j < count; ++j) {
+                    batch.set(j, triangles1, pairs[begin + j].first.idx(), triangles2, pairs[begin + j].second.idx());
+                }
+                triangle_pairs_may_intersect(batch, count, keep.data() + begin);
+            }
+        });
+        std::vector<Segment_3> filtered_segments;
+        result.times.time("filtered_intersection", [&]() {
+            for (std::size_t i = 0; i < pairs.size(); ++i) {
+                if (keep[i]) intersect_triangles(face_triangle(copy1, pairs[i].first), face_triangle(copy2, pairs[i].second), filtered_segments);
+            }
+        });
+        // 完整调用: 包围盒过滤、预筛选、精确求交与 PLY 输出
+        result.times.time("total", [&]() { intersection_line(copy1, copy2, output); });
+        result.counters = {{"candidate_pairs", pairs.size()},
+                           {"prefilter_kept", static_cast<std::size_t>(std::count(keep.begin(), keep.end(), std::uint8_t(1)))},
+                           {"segments", segments.size()},
+                           {"filtered_segments", filtered_segments.size()}};
+    }
+    return result;
+}
+
+inline void write_json_string(std::ostream& out, const std::string& value) {
+    out << '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+inline void write_json_report(const std::string& file_path, const std::vector<BenchResult>& results, const BenchConfig& config) {
+    std::ofstream out(file_path);
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"benchmark\": \"mesh_intersection_bench\",\n";
+    out << "  \"cgal_version\": ";
+    write_json_string(out, CGAL_VERSION_STR);
+    out << ",\n  \"repetitions\": " << config.repetitions << ",\n  \"results\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\n      \"name\": ";
+        write_json_string(out, result.name);
+        out << ",\n      \"mesh1_faces\": " << result.mesh1_faces << ",\n      \"mesh2_faces\": " << result.mesh2_faces;
+        out << ",\n      \"stages\": {";
+        const auto& stages = result.times.stages();
+        for (std::size_t s = 0; s < stages.size(); ++s) {
+            const auto& samples = stages[s].second;
+            double total = 0.0;
+            for (double sample : samples) total += sample;
+            out << (s == 0 ? "\n" : ",\n") << "        ";
+            write_json_string(out, stages[s].first);
+            out << ": {\"min_ms\": " << *std::min_element(samples.begin(), samples.end())
+                << ", \"mean_ms\": " << total / static_cast<double>(samples.size())
+                << ", \"max_ms\": " << *std::max_element(samples.begin(), samples.end()) << "}";
+        }
+        out << "\n      },\n      \"counters\": {";
+        for (std::size_t c = 0; c < result.counters.size(); ++c) {
+            out << (c == 0 ? "" : ", ");
+            write_json_string(out, result.counters[c].first);
+            out << ": " << result.counters[c].second;
+        }
+        out << "}\n    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--repetitions=", 0) == 0) {
+            config.repetitions = std::max(1, std::stoi(arg.substr(14)));
+        } else if (arg.rfind("--min-faces=", 0) == 0) {
+            config.min_faces = std::stoul(arg.substr(12));
+        } else if (arg.rfind("--max-faces=", 0) == 0) {
+            config.max_faces = std::stoul(arg.substr(12));
+        } else if (arg.rfind("--filter=", 0) == 0) {
+            config.filter = arg.substr(9);
+        } else if (arg.rfind("--data-dir=", 0) == 0) {
+            config.data_dir = arg.substr(11);
+        } else if (arg.rfind("--output=", 0) == 0) {
+            config.output = arg.substr(9);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--repetitions=N] [--min-faces=N] [--max-faces=N] [--filter=S] [--data-dir=DIR] [--output=FILE]" << std::endl;
+            return 1;
+        }
+    }
+    config.work_dir = std::filesystem::temp_directory_path() / "mesh_intersection_bench";
+    std::filesystem::create_directories(config.work_dir);
+
+    std::vector<BenchResult> results;
+    auto run = [&](const std::string& name, const std::function<BenchResult()>& bench) {
+        if (!config.filter.empty() && name.find(config.filter) == std::string::npos) return;
+        std::cerr << "Running " << name << std::endl;
+        results.push_back(bench());
+    };
+
+    // 合成网格
+    const Point3D sphere_center(0.05, 0.03, 0.02);
+    for (std::size_t faces = 1000; faces <= 1000000; faces *= 10) {
+        if (faces < config.min_faces || faces > config.max_faces) continue;
+        const std::string suffix = "/" + std::to_string(faces);
+        const auto sphere = make_sphere(sphere_center, 1.0, faces);
+        const auto cone = make_cone({0.1, -0.07, -0.8}, 0.9, 2.3, faces);
+        const auto plane = make_plane(2.0, faces);
+        const auto terrain = make_terrain(2.0, faces);
+
+        run("clip/sphere_terrain" + suffix, [&]() { return bench_clip<K>("clip/", "sphere_terrain" + suffix, sphere, terrain, config); });
+        run("clip/cone_plane" + suffix, [&]() { return bench_clip<K>("clip/", "cone_plane" + suffix, cone, plane, config); });
+        // 同一输入在 Epeck 下的对照 (float 内核的谓词不精确，不用于裁剪)
+        run("clip_epeck/cone_plane" + suffix, [&]() { return bench_clip<EK>("clip_epeck/", "cone_plane" + suffix, cone, plane, config); });
+        run("multi_clip/spheres_terrain" + suffix, [&]() {
+            // 4x4 个互不交叠的小球，总面数与其余用例相同
+            std::vector<std::vector<Triangle3D>> spheres;
+            for (int i = 0; i < 4; ++i) {
+                for (int j = 0; j < 4; ++j) {
+                    spheres.push_back(make_sphere({-1.5 + i + 0.03, -1.5 + j + 0.02, 0.01}, 0.3, std::max<std::size_t>(faces / 16, 200)));
+                }
+            }
+            return bench_multi_clip("spheres_terrain" + suffix, spheres, terrain, config);
+        });
+        run("co_refinement/sphere_plane" + suffix, [&]() {
+            return bench_co_refinement("sphere_plane" + suffix, make_mesh(sphere), make_mesh(plane), config);
+        });
+        run("mesh_intersection/sphere_cone" + suffix, [&]() {
+            return bench_boolean("sphere_cone" + suffix, make_mesh(sphere), make_mesh(cone), config);
+        });
+        run("intersection_line/sphere_terrain" + suffix, [&]() {
+            return bench_intersection_line("sphere_terrain" + suffix, make_mesh(sphere), make_mesh(terrain), config);
+        });
+    }
+
+    // data 目录下的网格: 圆锥 (封闭) 与平面
+    const std::pair<std::string, std::string> data_pairs[] = {{"Cone.ply", "Plane.ply"}, {"Cone_refine.ply", "Plane_refine.ply"}};
+    for (const auto& [cone_file, plane_file] : data_pairs) {
+        Mesh cone, plane;
+        const std::filesystem::path data_dir(config.data_dir);
+        if (!read_ply_mesh((data_dir / cone_file).string(), cone) || !read_ply_mesh((data_dir / plane_file).string(), plane)) {
+            continue;
+        }
+        const std::string name = "data/" + cone_file + "+" + plane_file;
+        std::vector<Triangle3D> cone_triangles, plane_triangles;
+        MeshToTriangles(cone, cone_triangles);
+        MeshToTriangles(plane, plane_triangles);
+        run("clip/" + name, [&]() { return bench_clip<K>("clip/", name, cone_triangles, plane_triangles, config); });
+        run("clip_epeck/" + name, [&]() { return bench_clip<EK>("clip_epeck/", name, cone_triangles, plane_triangles, config); });
+        run("co_refinement/" + name, [&]() { return bench_co_refinement(name, cone, plane, config); });
+        run("intersection_line/" + name, [&]() { return bench_intersection_line(name, cone, plane, config); });
+    }
+
+    write_json_report(config.output, results, config);
+    std::cerr << "Wrote " << results.size() << " results to " << config.output << std::endl;
+    return 0;
+}
@@ -0,0 +1,253 @@
+//
+// Created by RainSure on 24-10-12.
+//
+
+#ifndef MESH_INTERSECTION_BATCH_H
+#define MESH_INTERSECTION_BATCH_H
+
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "examples/binary_mesh_io.h"
+#include "examples/co_refinement.h"
+#include "examples/intersection_line.h"
+#include "examples/mesh_intersection.h"
+#include "examples/thread_pool.h"
+
+/**
+ * 批处理清单，每行一个作业，'#' 开头的行为注释，路径中不能含空白:
+ *   clip              <input> <output>                          输入/输出为 mesh1/mesh2 文本或 .mbin 文件
+ *   co_refinement     <mesh1> <mesh2> <output1> <output2>
+ *   boolean           <mesh1> <mesh2> <output_intersection> <output_union>
+ *   boolean           <mesh1> <mesh2> [--union=FILE] [--intersection=FILE] [--mesh1-minus-mesh2=FILE] [--mesh2-minus-mesh1=FILE] [--kernel=NAME]
+ *   intersection_line <mesh1.ply> <mesh2.ply> <output.ply>
+ * boolean 的选项与 boolean 命令相同，未给出 --kernel 时使用 batch 命令的 --kernel；其余操作不接受选项。
+ */
+enum class BatchOperation {
+    Clip,
+    CoRefinement,
+    Boolean,
+    IntersectionLine,
+};
+
+struct BatchJob {
+    BatchOperation operation;
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+    // boolean 作业的输出文件与内核 (不使用 outputs)
+    BooleanOptions boolean;
+    // 在清单中的行号，用于报错
+    std::size_t line = 0;
+};
+
+struct BatchOptions {
+    // 线程池大小，0 表示使用全部硬件线程
+    unsigned int num_threads = 0;
+    // 同时处于读取或计算中的作业数上限，0 表示线程数的 2 倍
+    std::size_t max_jobs_in_flight = 0;
+    // clip 作业的选项；作业之间已经并行，作业内部固定使用单线程
+    ClipOptions clip;
+};
+
+// 读取清单；default_kernel 为 boolean 作业未给出 --kernel 时使用的内核
+inline bool ReadBatchManifest(const std::string& file_path, std::vector<BatchJob>& jobs, MeshKernel default_kernel = MeshKernel::Epick) {
+    std::ifstream infile(file_path);
+    if (!infile.is_open()) {
+        std::cerr << "Error: Unable to open manifest " << file_path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    std::size_t line_number = 0;
+    while (std::getline(infile, line)) {
+        ++line_number;
+        std::istringstream fields(line);
+        std::string operation;
+        if (!(fields >> operation) || operation[0] == '#') continue;
+
+        BatchJob job;
+        job.line = line_number;
+        std::size_t num_inputs;
+        if (operation == "clip") {
+            job.operation = BatchOperation::Clip;
+            num_inputs = 1;
+        } else if (operation == "co_refinement") {
+            job.operation = BatchOperation::CoRefinement;
+            num_inputs = 2;
+        } else if (operation == "boolean") {
+            job.operation = BatchOperation::Boolean;
+            num_inputs = 2;
+        } else if (operation == "intersection_line") {
+            job.operation = BatchOperation::IntersectionLine;
+            num_inputs = 2;
+        } else {
+            std::cerr << "Error: " << file_path << ":" << line_number << ": unknown operation " << operation << std::endl;
+            return false;
+        }
+        const std::size_t num_outputs = job.operation == BatchOperation::Clip || job.operation == BatchOperation::IntersectionLine ? 1 : 2;
+
+        job.boolean.kernel = default_kernel;
+        std::vector<std::string> paths;
+        for (std::string field; fields >> field;) {
+            if (field.rfind("--", 0) != 0) {
+                paths.push_back(field);
+                continue;
+            }
+            bool parsed = false;
+            try {
+                parsed = job.operation == BatchOperation::Boolean && ParseBooleanOption(field, job.boolean);
+            } catch (const std::invalid_argument& e) {
+                std::cerr << "Error: " << file_path << ":" << line_number << ": " << e.what() << std::endl;
+                return false;
+            }
+            if (!parsed) {
+                std::cerr << "Error: " << file_path << ":" << line_number << ": unsupported option " << field << " for " << operation << std::endl;
+                return false;
+            }
+        }
+        if (job.operation == BatchOperation::Boolean && HasBooleanOutput(job.boolean)) {
+            // 输出由选项给出时不接受位置参数形式的输出
+            if (paths.size() != num_inputs) {
+                std::cerr << "Error: " << file_path << ":" << line_number << ": boolean expects 2 inputs when outputs are given as options" << std::endl;
+                return false;
+            }
+            job.inputs = std::move(paths);
+            jobs.push_back(std::move(job));
+            continue;
+        }
+        if (paths.size() != num_inputs + num_outputs) {
+            std::cerr << "Error: " << file_path << ":" << line_number << ": " << operation << " expects "
+                      << num_inputs << " input(s) and " << num_outputs << " output(s)" << std::endl;
+            return false;
+        }
+        job.inputs.assign(paths.begin(), paths.begin() + static_cast<std::ptrdiff_t>(num_inputs));
+        job.outputs.assign(paths.begin() + static_cast<std::ptrdiff_t>(num_inputs), paths.end());
+        if (job.operation == BatchOperation::Boolean) {
+            job.boolean.output_files[0] = job.outputs[1];
+            job.boolean.output_files[1] = job.outputs[0];
+        }
+        jobs.push_back(std::move(job));
+    }
+    return true;
+}
+
+// 作业读入后的数据: clip 使用 data1/data2，Epeck 内核的 boolean 使用 exact_mesh1/exact_mesh2，其余操作使用 mesh1/mesh2
+struct LoadedBatchJob {
+    MeshData data1, data2;
+    Mesh mesh1, mesh2;
+    Kernel_mesh<EK> exact_mesh1, exact_mesh2;
+};
+
+template <class Kernel>
+bool read_batch_meshes(const BatchJob& job, Kernel_mesh<Kernel>& mesh1, Kernel_mesh<Kernel>& mesh2) {
+    if (!PMP::IO::read_polygon_mesh(job.inputs[0], mesh1) || !PMP::IO::read_polygon_mesh(job.inputs[1], mesh2)) {
+        std::cerr << "Error: Unable to read " << job.inputs[0] << " or " << job.inputs[1] << std::endl;
+        return false;
+    }
+    return true;
+}
+
+inline bool load_batch_job(const BatchJob& job, LoadedBatchJob& loaded) {
+    switch (job.operation) {
+        case BatchOperation::Clip:
+            return ReadMeshFile(job.inputs[0], loaded.data1, loaded.data2, 1);
+        case BatchOperation::CoRefinement:
+            return read_batch_meshes(job, loaded.mesh1, loaded.mesh2);
+        case BatchOperation::Boolean:
+            if (job.boolean.kernel == MeshKernel::Epeck) return read_batch_meshes(job, loaded.exact_mesh1, loaded.exact_mesh2);
+            return read_batch_meshes(job, loaded.mesh1, loaded.mesh2);
+        case BatchOperation::IntersectionLine:
+            return read_ply_mesh(job.inputs[0], loaded.mesh1) && read_ply_mesh(job.inputs[1], loaded.mesh2);
+    }
+    return false;
+}
+
+inline bool run_batch_job(const BatchJob& job, LoadedBatchJob& loaded, const BatchOptions& options) {
+    switch (job.operation) {
+        case BatchOperation::Clip: {
+            ClipOptions clip_options = options.clip;
+            clip_options.num_threads = 1;
+            const auto boundary_points = ClipMesh(loaded.data1.triangles, loaded.data2.triangles, clip_options);
+            return WriteMeshFile(job.outputs[0], loaded.data1, loaded.data2, boundary_points);
+        }
+        case BatchOperation::CoRefinement:
+            co_refinement(loaded.mesh1, loaded.mesh2, job.outputs[0], job.outputs[1], options.clip.local_corefine);
+            return true;
+        case BatchOperation::Boolean:
+            if (job.boolean.kernel == MeshKernel::Epeck) return boolean_operations(loaded.exact_mesh1, loaded.exact_mesh2, job.boolean.output_files);
+            return boolean_operations(loaded.mesh1, loaded.mesh2, job.boolean.output_files);
+        case BatchOperation::IntersectionLine: {
+            Intersection_line_options line_options;
+            line_options.num_threads = 1;
+            return intersection_line(loaded.mesh1, loaded.mesh2, job.outputs[0], line_options);
+        }
+    }
+    return false;
+}
+
+/**
+ * 在工作窃取线程池上运行清单中的作业，返回失败的作业数。
+ * 每个作业分为读取与计算两个任务，读取完成后计算任务提交到同一线程的队列；
+ * 最多 max_jobs_in_flight 个作业同时在途，一个作业结束后才开始读取下一个，
+ * 因此后续作业的文件读取与当前作业的几何计算重叠进行，而内存占用有上限。
+ */
+inline std::size_t RunBatch(const std::vector<BatchJob>& jobs, const BatchOptions& options = BatchOptions()) {
+    WorkStealingPool pool(options.num_threads);
+    const std::size_t max_in_flight = options.max_jobs_in_flight > 0 ? options.max_jobs_in_flight : pool.size() * 2;
+
+    std::atomic<std::size_t> next_job(0);
+    std::atomic<std::size_t> failed_jobs(0);
+    auto report_failure = [&](const BatchJob& job, const std::string& reason) {
+        ++failed_jobs;
+        std::cerr << "Error: batch job at line " << job.line << " failed" << (reason.empty() ? "" : ": ") << reason << std::endl;
+    };
+
+    std::function<void()> start_next_job = [&]() {
+        const std::size_t index = next_job++;
+        if (index >= jobs.size()) return;
+        pool.submit([&, index]() {
+            const BatchJob& job = jobs[index];
+            auto loaded = std::make_shared<LoadedBatchJob>();
+            bool ok = false;
+            try {
+                ok = load_batch_job(job, *loaded);
+            } catch (const std::exception& e) {
+                report_failure(job, e.what());
+                start_next_job();
+                return;
+            }
+            if (!ok) {
+                report_failure(job, "");
+                start_next_job();
+                return;
+            }
+
+            pool.submit([&, index, loaded]() {
+                const BatchJob& job = jobs[index];
+                try {
+                    if (!run_batch_job(job, *loaded, options)) report_failure(job, "");
+                } catch (const std::exception& e) {
+                    report_failure(job, e.what());
+                }
+                start_next_job();
+            });
+        });
+    };
+
+    for (std::size_t i = 0; i < max_in_flight && i < jobs.size(); ++i) {
+        start_next_job();
+    }
+    pool.wait();
+
+    std::cerr << "Batch completed: " << jobs.size() << " jobs, " << failed_jobs.load() << " failed." << std::endl;
+    return failed_jobs.load();
+}
+
+#endif //MESH_INTERSECTION_BATCH_H
@@ -0,0 +1,331 @@
+//
+// Created by RainSure on 24-9-24.
+//
+
+#ifndef MESH_INTERSECTION_BINARY_MESH_IO_H
+#define MESH_INTERSECTION_BINARY_MESH_IO_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "examples/mapped_file.h"
+#include "examples/mesh_data.h"
+
+/**
+ * 二进制网格文件 (.mbin)，所有数值均为小端序，各数据段从 8 字节对齐的偏移处开始:
+ *
+ * header (BinaryMeshHeader, 96 字节)
+ *   magic           char[8]  "MESHBIN1"
+ *   version         uint32   当前为 1
+ *   header_size     uint32   sizeof(BinaryMeshHeader)
+ *   meshes[2]       mesh1、mesh2 各一项: vertex_offset, vertex_count, triangle_offset, triangle_count (uint64)
+ *   boundary_offset uint64
+ *   boundary_count  uint64
+ * vertices   vertex_count 个 double[3]
+ * triangles  triangle_count 个 uint32[3]，为同一网格顶点数组中的下标
+ * boundary   boundary_count 个 double[3]，输入文件中为空
+ */
+static_assert(std::endian::native == std::endian::little, "binary mesh files are little-endian");
+static_assert(sizeof(Point3D) == 3 * sizeof(double), "Point3D must be three packed doubles");
+
+constexpr char kBinaryMeshMagic[8] = {'M', 'E', 'S', 'H', 'B', 'I', 'N', '1'};
+constexpr std::uint32_t kBinaryMeshVersion = 1;
+
+struct BinaryMeshSection {
+    std::uint64_t vertex_offset;
+    std::uint64_t vertex_count;
+    std::uint64_t triangle_offset;
+    std::uint64_t triangle_count;
+};
+
+struct BinaryMeshHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t header_size;
+    BinaryMeshSection meshes[2];
+    std::uint64_t boundary_offset;
+    std::uint64_t boundary_count;
+};
+static_assert(sizeof(BinaryMeshHeader) == 96, "unexpected BinaryMeshHeader layout");
+
+inline bool IsBinaryMeshFile(const std::string& file_path) {
+    const std::string extension = ".mbin";
+    return file_path.size() >= extension.size() &&
+           file_path.compare(file_path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+// 检查 [offset, offset + count * stride) 是否位于数据范围内
+inline bool binary_section_in_file(std::uint64_t offset, std::uint64_t count, std::uint64_t stride, std::size_t file_size) {
+    return offset <= file_size && count <= (file_size - offset) / stride;
+}
+
+// 读取一个网格段，顶点与下标原样放入 SoA 缓冲区；下标越界时返回 false
+inline bool read_binary_mesh(const char* data, std::size_t size, const BinaryMeshSection& section, MeshBuffers& mesh) {
+    if (!binary_section_in_file(section.vertex_offset, section.vertex_count, sizeof(Point3D), size) ||
+        !binary_section_in_file(section.triangle_offset, section.triangle_count, 3 * sizeof(std::uint32_t), size)) {
+        return false;
+    }
+
+    const char* vertex_data = data + section.vertex_offset;
+    mesh.x.resize(section.vertex_count);
+    mesh.y.resize(section.vertex_count);
+    mesh.z.resize(section.vertex_count);
+    for (std::uint64_t i = 0; i < section.vertex_count; ++i) {
+        Point3D p;
+        std::memcpy(&p, vertex_data + i * sizeof(Point3D), sizeof(Point3D));
+        mesh.x[i] = p.x;
+        mesh.y[i] = p.y;
+        mesh.z[i] = p.z;
+    }
+
+    mesh.indices.resize(section.triangle_count * 3);
+    if (!mesh.indices.empty()) {
+        std::memcpy(mesh.indices.data(), data + section.triangle_offset, mesh.indices.size() * sizeof(std::uint32_t));
+    }
+    for (std::uint32_t index : mesh.indices) {
+        if (index >= section.vertex_count) return false;
+    }
+    return true;
+}
+
+/**
+ * 解析内存中的 .mbin 数据 (文件映射或网络消息)，保持文件中的索引形式。失败时 error 给出原因。
+ */
+inline bool DecodeMeshBuffersBinary(const char* data, std::size_t size, MeshBuffers& mesh1, MeshBuffers& mesh2, std::string& error) {
+    BinaryMeshHeader header;
+    if (size < sizeof(header)) {
+        error = "truncated binary mesh data";
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kBinaryMeshMagic, sizeof(kBinaryMeshMagic)) != 0 ||
+        header.version != kBinaryMeshVersion || header.header_size != sizeof(header)) {
+        error = "not a version " + std::to_string(kBinaryMeshVersion) + " binary mesh";
+        return false;
+    }
+
+    if (!read_binary_mesh(data, size, header.meshes[0], mesh1) || !read_binary_mesh(data, size, header.meshes[1], mesh2)) {
+        error = "corrupt mesh section";
+        return false;
+    }
+    return true;
+}
+
+// 把 SoA 缓冲区中的三角形按坐标追加到 mesh
+inline void AppendBufferTriangles(const MeshBuffers& buffers, MeshData& mesh) {
+    auto point = [&buffers](std::uint32_t v) {
+        return Point3D(buffers.x[v], buffers.y[v], buffers.z[v]);
+    };
+    mesh.triangles.reserve(mesh.triangles.size() + buffers.indices.size() / 3);
+    for (std::size_t i = 0; i + 2 < buffers.indices.size(); i += 3) {
+        mesh.triangles.emplace_back(point(buffers.indices[i]), point(buffers.indices[i + 1]), point(buffers.indices[i + 2]));
+    }
+}
+
+/**
+ * 解析 .mbin 数据并展开为三角形列表，用于只接受三角形列表的流程；能直接使用索引数据时用 DecodeMeshBuffersBinary。
+ */
+inline bool DecodeMeshDataBinary(const char* data, std::size_t size, MeshData& mesh1, MeshData& mesh2, std::string& error) {
+    MeshBuffers buffers1, buffers2;
+    if (!DecodeMeshBuffersBinary(data, size, buffers1, buffers2, error)) return false;
+    AppendBufferTriangles(buffers1, mesh1);
+    AppendBufferTriangles(buffers2, mesh2);
+    return true;
+}
+
+// 读取 .mbin 文件，保持索引形式，可直接交给 ClipMesh 的 SoA 版本
+inline bool ReadMeshBuffersBinary(const std::string& file_path, MeshBuffers& mesh1, MeshBuffers& mesh2) {
+    ScopedTimer timer("read_mesh_data");
+    MappedFile file(file_path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open input file " << file_path << std::endl;
+        return false;
+    }
+
+    std::string error;
+    if (!DecodeMeshBuffersBinary(file.data(), file.size(), mesh1, mesh2, error)) {
+        std::cerr << "Error: " << file_path << ": " << error << std::endl;
+        return false;
+    }
+    StatsCount("read_bytes", file.size());
+    StatsCount("read_faces_mesh1", mesh1.indices.size() / 3);
+    StatsCount("read_faces_mesh2", mesh2.indices.size() / 3);
+    return true;
+}
+
+inline bool ReadMeshDataBinary(const std::string& file_path, MeshData& mesh1, MeshData& mesh2) {
+    MeshBuffers buffers1, buffers2;
+    if (!ReadMeshBuffersBinary(file_path, buffers1, buffers2)) return false;
+    AppendBufferTriangles(buffers1, mesh1);
+    AppendBufferTriangles(buffers2, mesh2);
+    return true;
+}
+
+inline std::uint64_t aligned_section_size(std::uint64_t size) {
+    return (size + 7) / 8 * 8;
+}
+
+// 一个网格的索引数据: vertex_count 个顶点，triangle_count 个三角形 (每个三角形 3 个顶点下标)
+struct BinaryMeshArrays {
+    const Point3D* vertices = nullptr;
+    std::size_t vertex_count = 0;
+    const std::uint32_t* indices = nullptr;
+    std::size_t triangle_count = 0;
+};
+
+/**
+ * 按 .mbin 格式输出已是索引形式的两个网格与边界点，sink(const char* data, std::size_t size) 依次接收各段字节。
+ */
+template <class Sink>
+void encode_binary_mesh_arrays(const BinaryMeshArrays& mesh1, const BinaryMeshArrays& mesh2,
+                               const Point3D* boundary_points, std::size_t boundary_count, Sink&& sink) {
+    // 写入 size 字节，并用 0 补齐到 8 字节对齐
+    auto write_section = [&sink](const void* data, std::size_t size) {
+        static const char padding[8] = {};
+        if (size > 0) sink(static_cast<const char*>(data), size);
+        if (size % 8 != 0) sink(padding, 8 - size % 8);
+    };
+
+    const BinaryMeshArrays* meshes[2] = {&mesh1, &mesh2};
+    BinaryMeshHeader header{};
+    std::memcpy(header.magic, kBinaryMeshMagic, sizeof(kBinaryMeshMagic));
+    header.version = kBinaryMeshVersion;
+    header.header_size = sizeof(header);
+    std::uint64_t offset = sizeof(header);
+    for (int m = 0; m < 2; ++m) {
+        BinaryMeshSection& section = header.meshes[m];
+        section.vertex_offset = offset;
+        section.vertex_count = meshes[m]->vertex_count;
+        offset += aligned_section_size(section.vertex_count * sizeof(Point3D));
+        section.triangle_offset = offset;
+        section.triangle_count = meshes[m]->triangle_count;
+        offset += aligned_section_size(section.triangle_count * 3 * sizeof(std::uint32_t));
+    }
+    header.boundary_offset = offset;
+    header.boundary_count = boundary_count;
+
+    write_section(&header, sizeof(header));
+    for (int m = 0; m < 2; ++m) {
+        write_section(meshes[m]->vertices, meshes[m]->vertex_count * sizeof(Point3D));
+        write_section(meshes[m]->indices, meshes[m]->triangle_count * 3 * sizeof(std::uint32_t));
+    }
+    write_section(boundary_points, boundary_count * sizeof(Point3D));
+}
+
+/**
+ * 按 .mbin 格式输出三角形列表，先合并坐标完全相同的顶点得到索引形式。
+ */
+template <class Sink>
+void encode_mesh_data_binary(const MeshData& mesh1, const MeshData& mesh2, const std::vector<Point3D>& boundary_points, Sink&& sink) {
+    VertexWelder welders[2];
+    std::vector<std::array<std::uint32_t, 3>> triangles[2];
+    BinaryMeshArrays arrays[2];
+    const MeshData* meshes[2] = {&mesh1, &mesh2};
+    for (int m = 0; m < 2; ++m) {
+        welders[m] = VertexWelder(0.0, meshes[m]->triangles.size());
+        triangles[m].reserve(meshes[m]->triangles.size());
+        for (const auto& triangle : meshes[m]->triangles) {
+            triangles[m].push_back({welders[m].insert(triangle.points[0]),
+                                    welders[m].insert(triangle.points[1]),
+                                    welders[m].insert(triangle.points[2])});
+        }
+        arrays[m] = {welders[m].points().data(), welders[m].points().size(), reinterpret_cast<const std::uint32_t*>(triangles[m].data()), triangles[m].size()};
+    }
+    encode_binary_mesh_arrays(arrays[0], arrays[1], boundary_points.data(), boundary_points.size(), sink);
+}
+
+inline void EncodeMeshDataBinary(const MeshData& mesh1, const MeshData& mesh2, const std::vector<Point3D>& boundary_points, std::string& out) {
+    encode_mesh_data_binary(mesh1, mesh2, boundary_points, [&out](const char* data, std::size_t size) {
+        out.append(data, size);
+    });
+}
+
+inline bool WriteMeshDataBinary(const std::string& file_path, const MeshData& mesh1, const MeshData& mesh2, const std::vector<Point3D>& boundary_points) {
+    ScopedTimer timer("write_mesh_data");
+    std::ofstream outfile(file_path, std::ios::binary);
+    if (!outfile.is_open()) {
+        std::cerr << "Error: Unable to open output file " << file_path << std::endl;
+        return false;
+    }
+
+    encode_mesh_data_binary(mesh1, mesh2, boundary_points, [&outfile](const char* data, std::size_t size) {
+        outfile.write(data, static_cast<std::streamsize>(size));
+    });
+
+    if (!outfile) {
+        std::cerr << "Error: Failed to write output file " << file_path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// SoA 缓冲区中的点按 Point3D 交错排列
+inline std::vector<Point3D> interleave_points(const PointBuffers& points) {
+    std::vector<Point3D> interleaved;
+    interleaved.reserve(points.x.size());
+    for (std::size_t i = 0; i < points.x.size(); ++i) {
+        interleaved.emplace_back(points.x[i], points.y[i], points.z[i]);
+    }
+    return interleaved;
+}
+
+/**
+ * 把 SoA 缓冲区直接写成 .mbin 文件，缓冲区已是索引形式，不再合并顶点。
+ */
+inline bool WriteMeshBuffersBinary(const std::string& file_path, const MeshBuffers& mesh1, const MeshBuffers& mesh2, const PointBuffers& boundary_points) {
+    ScopedTimer timer("write_mesh_data");
+    std::ofstream outfile(file_path, std::ios::binary);
+    if (!outfile.is_open()) {
+        std::cerr << "Error: Unable to open output file " << file_path << std::endl;
+        return false;
+    }
+
+    const std::vector<Point3D> vertices1 = interleave_points(mesh1);
+    const std::vector<Point3D> vertices2 = interleave_points(mesh2);
+    const std::vector<Point3D> boundary = interleave_points(boundary_points);
+    encode_binary_mesh_arrays({vertices1.data(), vertices1.size(), mesh1.indices.data(), mesh1.indices.size() / 3},
+                              {vertices2.data(), vertices2.size(), mesh2.indices.data(), mesh2.indices.size() / 3},
+                              boundary.data(), boundary.size(),
+                              [&outfile](const char* data, std::size_t size) {
+                                  outfile.write(data, static_cast<std::streamsize>(size));
+                              });
+
+    if (!outfile) {
+        std::cerr << "Error: Failed to write output file " << file_path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 按扩展名选择格式: .mbin 为二进制格式，其余为文本格式
+inline bool ReadMeshFile(const std::string& file_path, MeshData& mesh1, MeshData& mesh2, unsigned int num_threads = 1) {
+    return IsBinaryMeshFile(file_path) ? ReadMeshDataBinary(file_path, mesh1, mesh2)
+                                       : ReadMeshData(file_path, mesh1, mesh2, num_threads);
+}
+
+inline bool WriteMeshFile(const std::string& file_path, const MeshData& mesh1, const MeshData& mesh2, const std::vector<Point3D>& boundary_points) {
+    if (IsBinaryMeshFile(file_path)) {
+        return WriteMeshDataBinary(file_path, mesh1, mesh2, boundary_points);
+    }
+    WriteMeshData(file_path, mesh1, mesh2, boundary_points);
+    return true;
+}
+
+// 按扩展名选择格式写出 SoA 缓冲区: .mbin 直接写索引数据，其余展开为三角形后按文本格式写出
+inline bool WriteMeshBuffersFile(const std::string& file_path, const MeshBuffers& mesh1, const MeshBuffers& mesh2, const PointBuffers& boundary_points) {
+    if (IsBinaryMeshFile(file_path)) {
+        return WriteMeshBuffersBinary(file_path, mesh1, mesh2, boundary_points);
+    }
+    MeshData data1, data2;
+    AppendBufferTriangles(mesh1, data1);
+    AppendBufferTriangles(mesh2, data2);
+    WriteMeshData(file_path, data1, data2, interleave_points(boundary_points));
+    return true;
+}
+
+#endif //MESH_INTERSECTION_BINARY_MESH_IO_H
@@ -0,0 +1,412 @@
+//
+// Created by RainSure on 24-10-8.
+//
+
+#ifndef MESH_INTERSECTION_CLIP_SERVER_H
+#define MESH_INTERSECTION_CLIP_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "examples/binary_mesh_io.h"
+#include "examples/co_refinement.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+/**
+ * 常驻裁剪服务: 保存若干已注册的裁剪体 (网格及其 AABB 树)，对每个请求只做裁剪本身。
+ *
+ * 消息 (请求与响应相同): uint64 负载长度 + 负载，均为小端序。
+ * 请求负载:
+ *   command    uint8    1 = 注册裁剪体, 2 = 裁剪, 3 = 注销裁剪体, 4 = 关闭服务 (名称为空)
+ *   reserved   uint8[3]
+ *   name_size  uint32
+ *   name       char[name_size]   裁剪体名称
+ *   body       注册: .mbin 数据，mesh1 为裁剪体；裁剪: .mbin 数据，mesh2 为被裁剪的网格；注销与关闭: 空
+ * 响应负载:
+ *   status     uint8    0 = 成功, 1 = 失败
+ *   reserved   uint8[3]
+ *   body       成功的裁剪请求: .mbin 数据 (mesh1 为共精细化后的裁剪体, mesh2 为裁剪结果, 以及边界点)；
+ *              失败: 错误信息文本；其他情况为空
+ * 负载长度超过 max_frame_size 的请求不被读取，直接关闭连接。
+ * 关闭服务的请求得到响应后，服务不再接受新的连接与请求，正在处理的请求完成后退出。
+ * 裁剪请求只读共享的裁剪体，不复制整个裁剪体网格 (见 clip_with_cutter)。
+ */
+enum class ClipServerCommand : std::uint8_t {
+    RegisterCutter = 1,
+    Clip = 2,
+    UnregisterCutter = 3,
+    Shutdown = 4,
+};
+
+// 默认的请求负载长度上限
+constexpr std::uint64_t kDefaultMaxClipFrameSize = std::uint64_t(1) << 30;
+
+class ClipServer {
+public:
+    explicit ClipServer(const ClipOptions& options = ClipOptions(), std::uint64_t max_frame_size = kDefaultMaxClipFrameSize)
+            : options_(options), max_frame_size_(max_frame_size) {}
+
+    std::uint64_t max_frame_size() const { return max_frame_size_; }
+
+    // 收到关闭服务的请求后为 true
+    bool shutdown_requested() const { return shutdown_requested_.load(); }
+    void request_shutdown() { shutdown_requested_ = true; }
+
+    // 注册 (或替换) 名为 name 的裁剪体，裁剪体必须是封闭的三角网格
+    bool register_cutter(const std::string& name, const std::vector<Triangle3D>& triangles, std::string& error) {
+        Mesh mesh;
+        BuildMesh(triangles, mesh, options_);
+        if (mesh.number_of_faces() == 0 || !CGAL::is_triangle_mesh(mesh) || !CGAL::is_closed(mesh)) {
+            error = "cutter '" + name + "' is not a closed triangle mesh";
+            return false;
+        }
+        auto cutter = std::make_shared<const ClipCutter>(std::move(mesh));
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        cutters_[name] = std::move(cutter);
+        return true;
+    }
+
+    bool unregister_cutter(const std::string& name) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        return cutters_.erase(name) > 0;
+    }
+
+    std::shared_ptr<const ClipCutter> find_cutter(const std::string& name) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const auto it = cutters_.find(name);
+        return it == cutters_.end() ? nullptr : it->second;
+    }
+
+    // 处理一个请求负载，返回响应负载
+    std::string handle(const std::string& request) {
+        try {
+            std::string error;
+            std::string body;
+            if (handle(request, body, error)) {
+                return response(0, body);
+            }
+            return response(1, error);
+        } catch (const std::exception& e) {
+            return response(1, e.what());
+        }
+    }
+
+private:
+    static std::string response(std::uint8_t status, const std::string& body) {
+        std::string payload(4, '\0');
+        payload[0] = static_cast<char>(status);
+        payload += body;
+        return payload;
+    }
+
+    bool handle(const std::string& request, std::string& body, std::string& error) {
+        if (request.size() < 8) {
+            error = "truncated request";
+            return false;
+        }
+        const auto command = static_cast<ClipServerCommand>(request[0]);
+        std::uint32_t name_size;
+        std::memcpy(&name_size, request.data() + 4, sizeof(name_size));
+        if (name_size > request.size() - 8) {
+            error = "truncated request";
+            return false;
+        }
+        const std::string name = request.substr(8, name_size);
+        const char* data = request.data() + 8 + name_size;
+        const std::size_t size = request.size() - 8 - name_size;
+
+        switch (command) {
+            case ClipServerCommand::RegisterCutter: {
+                MeshData mesh1, mesh2;
+                if (!DecodeMeshDataBinary(data, size, mesh1, mesh2, error)) return false;
+                return register_cutter(name, mesh1.triangles, error);
+            }
+            case ClipServerCommand::UnregisterCutter:
+                if (!unregister_cutter(name)) {
+                    error = "unknown cutter '" + name + "'";
+                    return false;
+                }
+                return true;
+            case ClipServerCommand::Shutdown:
+                request_shutdown();
+                return true;
+            case ClipServerCommand::Clip: {
+                const auto cutter = find_cutter(name);
+                if (cutter == nullptr) {
+                    error = "unknown cutter '" + name + "'";
+                    return false;
+                }
+                MeshBuffers buffers1, buffers2;
+                if (!DecodeMeshBuffersBinary(data, size, buffers1, buffers2, error)) return false;
+
+                // 请求中的网格已是索引形式，只有指定了焊接容差或不焊接时才展开为三角形重新构造
+                MeshData mesh1, mesh2;
+                Mesh cgal_mesh2;
+                if (options_.weld_vertices && options_.weld_tolerance == 0.0) {
+                    BuildMesh(buffers2.view(), cgal_mesh2);
+                } else {
+                    AppendBufferTriangles(buffers2, mesh2);
+                    BuildMesh(mesh2.triangles, cgal_mesh2, options_);
+                }
+                const auto points_in_boundary = clip_with_cutter(*cutter, mesh1.triangles, cgal_mesh2, options_);
+
+                std::vector<Point3D> boundary_points;
+                boundary_points.reserve(points_in_boundary.size());
+                for (const auto& point : points_in_boundary) {
+                    boundary_points.emplace_back(point.x(), point.y(), point.z());
+                }
+                MeshToTriangles(cgal_mesh2, mesh2.triangles);
+                EncodeMeshDataBinary(mesh1, mesh2, boundary_points, body);
+                return true;
+            }
+        }
+        error = "unknown command " + std::to_string(static_cast<int>(request[0]));
+        return false;
+    }
+
+    ClipOptions options_;
+    std::uint64_t max_frame_size_;
+    std::atomic<bool> shutdown_requested_{false};
+    mutable std::shared_mutex mutex_;
+    std::map<std::string, std::shared_ptr<const ClipCutter>> cutters_;
+};
+
+/**
+ * 依次读取请求并写回响应，直到输入结束、请求长度超过 server.max_frame_size()，或服务收到关闭请求。
+ * read(char*, std::size_t) 与 write(const char*, std::size_t) 在读写完全部字节时返回 true。
+ */
+template <class Read, class Write>
+void serve_clip_frames(ClipServer& server, Read&& read, Write&& write) {
+    for (;;) {
+        std::uint64_t size;
+        if (!read(reinterpret_cast<char*>(&size), sizeof(size))) return;
+        if (size > server.max_frame_size()) {
+            std::cerr << "Error: Request of " << size << " bytes exceeds the limit of " << server.max_frame_size()
+                      << " bytes, closing connection" << std::endl;
+            return;
+        }
+        std::string request;
+        try {
+            request.resize(static_cast<std::size_t>(size));
+        } catch (const std::bad_alloc&) {
+            std::cerr << "Error: Unable to allocate " << size << " bytes for a request, closing connection" << std::endl;
+            return;
+        }
+        if (size > 0 && !read(request.data(), request.size())) return;
+
+        const std::string reply = server.handle(request);
+        const std::uint64_t reply_size = reply.size();
+        if (!write(reinterpret_cast<const char*>(&reply_size), sizeof(reply_size)) ||
+            !write(reply.data(), reply.size())) {
+            return;
+        }
+        if (server.shutdown_requested()) return;
+    }
+}
+
+// 从标准输入读取请求，响应写到标准输出；标准输出只用于响应，日志写到标准错误
+inline void ServeClipStdio(ClipServer& server) {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    serve_clip_frames(
+            server,
+            [](char* data, std::size_t size) { return std::fread(data, 1, size, stdin) == size; },
+            [](const char* data, std::size_t size) {
+                return std::fwrite(data, 1, size, stdout) == size && std::fflush(stdout) == 0;
+            });
+}
+
+#ifndef _WIN32
+// SIGINT/SIGTERM 时写入的唤醒管道，由 ServeClipUnixSocket 设置
+inline volatile std::sig_atomic_t clip_server_wake_fd = -1;
+
+extern "C" inline void clip_server_signal_handler(int) {
+    const int saved_errno = errno;
+    if (clip_server_wake_fd >= 0) {
+        [[maybe_unused]] const ssize_t n = write(clip_server_wake_fd, "s", 1);
+    }
+    errno = saved_errno;
+}
+#endif
+
+/**
+ * 在 Unix 域套接字 socket_path 上监听，每个连接由单独的线程处理，所有连接共享已注册的裁剪体。
+ * 连接线程由监听线程持有: 已结束的连接在下一次 accept 时回收。
+ * 收到关闭服务的请求或 SIGINT/SIGTERM 时停止接受连接，关闭所有连接的读端 (正在处理的请求仍可写回响应)，
+ * 等待线程退出，删除套接字文件并返回 true，因此返回后不再有线程访问 server，调用者可以写出统计结果。
+ */
+inline bool ServeClipUnixSocket(ClipServer& server, const std::string& socket_path) {
+#ifdef _WIN32
+    std::cerr << "Error: Unix domain sockets are not supported on this platform, use stdin mode" << std::endl;
+    return false;
+#else
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: Socket path is too long: " << socket_path << std::endl;
+        return false;
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    // 监听线程在套接字与唤醒管道上等待；信号处理函数与收到关闭请求的连接线程向管道写入一个字节
+    int wake[2];
+    if (pipe(wake) != 0) {
+        std::perror("pipe");
+        return false;
+    }
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::perror("socket");
+        close(wake[0]);
+        close(wake[1]);
+        return false;
+    }
+    unlink(socket_path.c_str());
+    if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0) {
+        std::perror(socket_path.c_str());
+        close(listener);
+        close(wake[0]);
+        close(wake[1]);
+        return false;
+    }
+
+    clip_server_wake_fd = wake[1];
+    struct sigaction action{}, previous_int{}, previous_term{};
+    action.sa_handler = clip_server_signal_handler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &previous_int);
+    sigaction(SIGTERM, &action, &previous_term);
+    std::cerr << "Clip server listening on " << socket_path << std::endl;
+
+    // 连接线程结束时只 shutdown 套接字，由监听线程在回收时 close，避免编号被新连接复用后误关
+    struct Connection {
+        int socket = -1;
+        std::atomic<bool> finished{false};
+        std::thread thread;
+    };
+    std::list<Connection> connections;
+    auto reap = [&connections](bool all) {
+        for (auto it = connections.begin(); it != connections.end();) {
+            if (!all && !it->finished.load()) {
+                ++it;
+                continue;
+            }
+            // 只关闭读端: 等待请求的线程立即读到结束，正在处理的请求仍可写回响应
+            if (all) shutdown(it->socket, SHUT_RD);
+            it->thread.join();
+            close(it->socket);
+            it = connections.erase(it);
+        }
+    };
+
+    bool success = true;
+    pollfd fds[2] = {{listener, POLLIN, 0}, {wake[0], POLLIN, 0}};
+    while (!server.shutdown_requested()) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            std::perror("poll");
+            success = false;
+            break;
+        }
+        if (fds[1].revents != 0) break;
+        if ((fds[0].revents & POLLIN) == 0) continue;
+
+        const int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            std::perror("accept");
+            success = false;
+            break;
+        }
+        reap(false);
+        Connection& connection = connections.emplace_back();
+        connection.socket = client;
+        try {
+            connection.thread = std::thread([&server, &connection, client, wake_fd = wake[1]]() {
+                auto read = [client](char* data, std::size_t size) {
+                    while (size > 0) {
+                        const ssize_t n = recv(client, data, size, 0);
+                        if (n < 0 && errno == EINTR) continue;
+                        if (n <= 0) return false;
+                        data += n;
+                        size -= static_cast<std::size_t>(n);
+                    }
+                    return true;
+                };
+                auto write = [client](const char* data, std::size_t size) {
+#ifdef MSG_NOSIGNAL
+                    const int flags = MSG_NOSIGNAL;
+#else
+                    const int flags = 0;
+#endif
+                    while (size > 0) {
+                        const ssize_t n = send(client, data, size, flags);
+                        if (n < 0 && errno == EINTR) continue;
+                        if (n <= 0) return false;
+                        data += n;
+                        size -= static_cast<std::size_t>(n);
+                    }
+                    return true;
+                };
+                try {
+                    serve_clip_frames(server, read, write);
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: Connection failed: " << e.what() << std::endl;
+                } catch (...) {
+                    std::cerr << "Error: Connection failed with an unknown exception" << std::endl;
+                }
+                // 立即结束连接；套接字本身在回收时关闭
+                shutdown(client, SHUT_RDWR);
+                if (server.shutdown_requested()) {
+                    [[maybe_unused]] const ssize_t n = ::write(wake_fd, "s", 1);
+                }
+                connection.finished = true;
+            });
+        } catch (const std::system_error& e) {
+            std::cerr << "Error: Unable to start a connection thread: " << e.what() << std::endl;
+            close(client);
+            connections.pop_back();
+        }
+    }
+    server.request_shutdown();
+    std::cerr << "Clip server shutting down" << std::endl;
+
+    close(listener);
+    unlink(socket_path.c_str());
+    reap(true);
+    sigaction(SIGINT, &previous_int, nullptr);
+    sigaction(SIGTERM, &previous_term, nullptr);
+    clip_server_wake_fd = -1;
+    close(wake[0]);
+    close(wake[1]);
+    return success;
+#endif
+}
+
+#endif //MESH_INTERSECTION_CLIP_SERVER_H
@@ -5,116 +5,268 @@
 #ifndef MESH_INTERSECTION_CO_REFINEMENT_H
 #define MESH_INTERSECTION_CO_REFINEMENT_H
 
-#include <CGAL/Simple_cartesian.h>
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/Surface_mesh.h>
 #include <CGAL/Polygon_mesh_processing/corefinement.h>
+#include <CGAL/AABB_tree.h>
+#include <CGAL/AABB_traits.h>
+#include <CGAL/AABB_face_graph_triangle_primitive.h>
+#include <CGAL/Side_of_triangle_mesh.h>
+#include <CGAL/Polygon_mesh_processing/bbox.h>
+#include <CGAL/Polygon_mesh_processing/connected_components.h>
+#include <CGAL/boost/graph/Euler_operations.h>
+#include <CGAL/box_intersection_d.h>
+#include <CGAL/Box_intersection_d/Box_with_info_d.h>
 #include <iostream>
+#include <algorithm>
 #include <array>
-
-typedef CGAL::Exact_predicates_inexact_constructions_kernel K;
-typedef CGAL::Surface_mesh<K::Point_3> Mesh;
-typedef Mesh::Edge_index Edge_index;
-typedef Mesh::Face_index Face_index;
+#include <cstdint>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include "examples/kernels.h"
+#include "examples/mesh_data.h"
+#include "examples/parallel.h"
+#include "examples/stats.h"
+
+// 以内核为参数的 AABB 树、点定位与属性图类型，不带 Kernel_ 前缀的为 Epick 下的类型
+template <class Kernel>
+using Kernel_face_tree = CGAL::AABB_tree<CGAL::AABB_traits<Kernel, CGAL::AABB_face_graph_triangle_primitive<Kernel_mesh<Kernel>>>>;
+template <class Kernel>
+using Kernel_point_inside = CGAL::Side_of_triangle_mesh<Kernel_mesh<Kernel>, Kernel, CGAL::Default, Kernel_face_tree<Kernel>>;
+template <class Kernel>
+using Kernel_vertex_side_map = typename Kernel_mesh<Kernel>::template Property_map<Vertex_index, CGAL::Bounded_side>;
+template <class Kernel>
+using Kernel_edge_constrained_map = typename Kernel_mesh<Kernel>::template Property_map<Edge_index, bool>;
+template <class Kernel>
+using Kernel_face_label_map = typename Kernel_mesh<Kernel>::template Property_map<Face_index, std::size_t>;
+
+typedef Kernel_face_tree<K> Face_tree;
+typedef Kernel_point_inside<K> Point_inside;
+typedef Kernel_vertex_side_map<K> Vertex_side_map;
+typedef Kernel_edge_constrained_map<K> Edge_constrained_map;
+typedef Kernel_face_label_map<K> Face_label_map;
+typedef CGAL::Box_intersection_d::Box_with_info_d<double, 3, Face_index> Face_box;
 
 namespace PMP = CGAL::Polygon_mesh_processing;
 
-struct Point3D{
-    Point3D() = default;
-    Point3D(double x, double y, double z) : x(x), y(y), z(z) {}
-    double x, y, z;
+struct ClipOptions {
+    // 是否焊接重合顶点，构造带索引的网格后再进行共精细化
+    bool weld_vertices = true;
+    // 焊接容差: 距离不超过该值的顶点视为同一个顶点；0 表示只合并坐标完全相同的点
+    double weld_tolerance = 0.0;
+    // 并行阶段使用的线程数，0 表示使用全部硬件线程
+    unsigned int num_threads = 1;
+    // 只对两网格交叠区域内的面做共精细化 (见 local_corefine)
+    bool local_corefine = false;
+    // true: 对每个顶点做点定位 (classify_vertices)；false: 每个由交线围成的面片只做一次点定位 (classify_patches)
+    bool vertex_classification = false;
+    // ClipMesh 构造网格所用的内核 (见 kernels.h)；Float 的谓词不精确，裁剪时改用 Epick
+    MeshKernel kernel = MeshKernel::Epick;
 };
 
-struct Triangle3D {
-    Triangle3D() = default;
-    Triangle3D(const std::array<Point3D, 3>& points) : points(points) {}
-    Triangle3D(const Point3D& p1, const Point3D& p2, const Point3D& p3) : points({p1, p2, p3}) {}
-    std::array<Point3D, 3> points;
-};
+/**
+ * 对 mesh1 与 mesh2 中包围盒相交的每一对面调用 callback(mesh1 的面, mesh2 的面)，同一对面可能被报告多次。
+ * 先用另一网格的整体包围盒过滤，只为交叠区域内的面建立包围盒。
+ */
+template <class Kernel, class Callback>
+void for_each_overlapping_face_pair(const Kernel_mesh<Kernel>& mesh1, const Kernel_mesh<Kernel>& mesh2, Callback&& callback) {
+    const CGAL::Bbox_3 bbox1 = PMP::bbox(mesh1);
+    const CGAL::Bbox_3 bbox2 = PMP::bbox(mesh2);
+    std::vector<Face_box> boxes1, boxes2;
+    for (Face_index f : mesh1.faces()) {
+        const CGAL::Bbox_3 box = PMP::face_bbox(f, mesh1);
+        if (CGAL::do_overlap(box, bbox2)) boxes1.emplace_back(box, f);
+    }
+    for (Face_index f : mesh2.faces()) {
+        const CGAL::Bbox_3 box = PMP::face_bbox(f, mesh2);
+        if (CGAL::do_overlap(box, bbox1)) boxes2.emplace_back(box, f);
+    }
 
-struct MeshData {
-    std::vector<Triangle3D> triangles;
-};
+    CGAL::box_intersection_d(boxes1.begin(), boxes1.end(), boxes2.begin(), boxes2.end(),
+                             [&callback](const Face_box& b1, const Face_box& b2) {
+                                 callback(b1.info(), b2.info());
+                             });
+}
 
-bool ReadMeshData(const std::string& file_path, MeshData& mesh1, MeshData& mesh2) {
-    std::ifstream infile(file_path);
-    if (!infile.is_open()) {
-        std::cerr << "Error: Unable to open input file " << file_path << std::endl;
-        return false;
+/**
+ * 找出 mesh1 与 mesh2 中包围盒与另一网格某个面的包围盒相交的面，结果排序。
+ */
+template <class Kernel>
+void overlapping_faces(const Kernel_mesh<Kernel>& mesh1, const Kernel_mesh<Kernel>& mesh2, std::vector<Face_index>& faces1, std::vector<Face_index>& faces2) {
+    for_each_overlapping_face_pair(mesh1, mesh2, [&faces1, &faces2](Face_index f1, Face_index f2) {
+        faces1.push_back(f1);
+        faces2.push_back(f2);
+    });
+    for (auto* faces : {&faces1, &faces2}) {
+        std::sort(faces->begin(), faces->end());
+        faces->erase(std::unique(faces->begin(), faces->end()), faces->end());
     }
+}
 
-    // Read the mesh data
-    std::string line;
-    std::vector<Point3D> points;
-    bool readingMesh1 = true;
-    while (std::getline(infile, line)) {
-        // 去掉前后的空格
-        line.erase(0, line.find_first_not_of(" \t"));
-        line.erase(line.find_last_not_of(" \t") + 1);
-
-        if (line == "mesh1") {
-            readingMesh1 = true;
-        } else if (line == "mesh2") {
-            readingMesh1 = false;
-        } else if (!line.empty()) {
-            // 直接读取 x, y, z
-            double x, y, z;
-            if (sscanf_s(line.c_str(), "%lf %lf %lf", &x, &y, &z) == 3) {
-                points.emplace_back(x, y, z);
-                if (points.size() == 3) {
-                    Triangle3D triangle(points[0], points[1], points[2]);
-                    if (readingMesh1) {
-                        mesh1.triangles.push_back(triangle);
-                    } else {
-                        mesh2.triangles.push_back(triangle);
-                    }
-                    points.clear();
-                }
-            } else {
-                std::cerr << "Error: Invalid format in line: " << line << std::endl;
-                return false;
+// 从网格中取出的一块面片
+template <class Kernel>
+struct LocalPatch {
+    Kernel_mesh<Kernel> mesh;
+    // 面片顶点对应的原网格顶点；只与面片内的面相邻、会随原面一起删除的顶点为 null
+    std::vector<Vertex_index> original;
+};
+
+// 把 mesh 中排好序的 faces 复制为面片
+template <class Kernel>
+void extract_patch(const Kernel_mesh<Kernel>& mesh, const std::vector<Face_index>& faces, LocalPatch<Kernel>& patch) {
+    typedef Kernel_mesh<Kernel> Mesh;
+    std::unordered_map<std::uint32_t, Vertex_index> to_patch;
+    auto patch_vertex = [&](Vertex_index v) {
+        const auto it = to_patch.find(v.idx());
+        if (it != to_patch.end()) return it->second;
+        // 还与面片外的面相邻的顶点在拼接时保留
+        bool shared = false;
+        for (Face_index f : CGAL::faces_around_target(mesh.halfedge(v), mesh)) {
+            if (f != Mesh::null_face() && !std::binary_search(faces.begin(), faces.end(), f)) {
+                shared = true;
+                break;
             }
         }
+        const Vertex_index pv = patch.mesh.add_vertex(mesh.point(v));
+        patch.original.push_back(shared ? v : Mesh::null_vertex());
+        to_patch.emplace(v.idx(), pv);
+        return pv;
+    };
+
+    for (Face_index f : faces) {
+        const auto h = mesh.halfedge(f);
+        patch.mesh.add_face(patch_vertex(mesh.target(h)), patch_vertex(mesh.target(mesh.next(h))),
+                            patch_vertex(mesh.target(mesh.next(mesh.next(h)))));
     }
-
-    infile.close();
-    return true;
 }
 
+/**
+ * 删除 mesh 中的 faces，把 (共精细化后的) 面片拼回去。面片的外边界与 faces 的边界相同，
+ * 面从外边界开始按广度优先顺序加入；无法以流形方式加入的面按原坐标单独加入。
+ * patch_constrained/mesh_constrained 非空时，把面片中的约束边转到 mesh 中对应的边上。
+ */
+template <class Kernel>
+void stitch_patch(Kernel_mesh<Kernel>& mesh, const std::vector<Face_index>& faces, const LocalPatch<Kernel>& patch,
+                  const Kernel_edge_constrained_map<Kernel>* patch_constrained = nullptr,
+                  Kernel_edge_constrained_map<Kernel>* mesh_constrained = nullptr) {
+    typedef Kernel_mesh<Kernel> Mesh;
+    for (Face_index f : faces) {
+        CGAL::Euler::remove_face(mesh.halfedge(f), mesh);
+    }
 
-void WriteMeshData(const std::string& file_path, const MeshData& mesh1, const MeshData& mesh2, const std::vector<Point3D>& boundary_points) {
-    std::ofstream outfile(file_path);
-    if (!outfile.is_open()) {
-        std::cerr << "Error: Unable to open output file " << file_path << std::endl;
-        return;
+    const Mesh& pm = patch.mesh;
+    std::vector<Vertex_index> to_mesh(pm.num_vertices());
+    for (Vertex_index v : pm.vertices()) {
+        to_mesh[v.idx()] = v.idx() < patch.original.size() && patch.original[v.idx()] != Mesh::null_vertex()
+                           ? patch.original[v.idx()] : mesh.add_vertex(pm.point(v));
     }
 
-    // Write mesh1
-    outfile << "mesh1:\n";
-    for (const auto& triangle : mesh1.triangles) {
-        for (const auto& point : triangle.points) {
-            outfile << point.x << ", " << point.y << ", " << point.z << "\n";
+    // 从带边界边的面开始广度优先遍历，使每个面加入时尽量与已有的面相邻
+    std::vector<Face_index> order;
+    order.reserve(pm.number_of_faces());
+    std::vector<char> visited(pm.num_faces(), 0);
+    auto visit_from = [&](Face_index seed) {
+        if (visited[seed.idx()]) return;
+        visited[seed.idx()] = 1;
+        std::size_t i = order.size();
+        order.push_back(seed);
+        for (; i < order.size(); ++i) {
+            for (auto h : CGAL::halfedges_around_face(pm.halfedge(order[i]), pm)) {
+                const Face_index g = pm.face(pm.opposite(h));
+                if (g != Mesh::null_face() && !visited[g.idx()]) {
+                    visited[g.idx()] = 1;
+                    order.push_back(g);
+                }
+            }
         }
+    };
+    for (Face_index f : pm.faces()) {
+        for (auto h : CGAL::halfedges_around_face(pm.halfedge(f), pm)) {
+            if (pm.is_border(pm.opposite(h))) {
+                visit_from(f);
+                break;
+            }
+        }
+    }
+    for (Face_index f : pm.faces()) {
+        visit_from(f);
     }
 
-    // Write mesh2
-    outfile << "mesh2:\n";
-    for (const auto& triangle : mesh2.triangles) {
-        for (const auto& point : triangle.points) {
-            outfile << point.x << ", " << point.y << ", " << point.z << "\n";
+    std::size_t soup_faces = 0;
+    for (Face_index f : order) {
+        const auto h = pm.halfedge(f);
+        const Vertex_index v0 = to_mesh[pm.target(h).idx()];
+        const Vertex_index v1 = to_mesh[pm.target(pm.next(h)).idx()];
+        const Vertex_index v2 = to_mesh[pm.target(pm.next(pm.next(h))).idx()];
+        if (mesh.add_face(v0, v1, v2) == Mesh::null_face()) {
+            // 先复制坐标: add_vertex 可能使点数组重新分配，引用 mesh.point() 会失效
+            const typename Mesh::Point p0 = mesh.point(v0);
+            const typename Mesh::Point p1 = mesh.point(v1);
+            const typename Mesh::Point p2 = mesh.point(v2);
+            const Vertex_index w0 = mesh.add_vertex(p0);
+            const Vertex_index w1 = mesh.add_vertex(p1);
+            const Vertex_index w2 = mesh.add_vertex(p2);
+            mesh.add_face(w0, w1, w2);
+            ++soup_faces;
+            continue;
+        }
+        if (patch_constrained == nullptr || mesh_constrained == nullptr) continue;
+        for (auto ph : CGAL::halfedges_around_face(h, pm)) {
+            if ((*patch_constrained)[pm.edge(ph)]) {
+                const auto mh = mesh.halfedge(to_mesh[pm.source(ph).idx()], to_mesh[pm.target(ph).idx()]);
+                (*mesh_constrained)[mesh.edge(mh)] = true;
+            }
         }
     }
-
-    // Write boundary points
-    outfile << "boundary_points:\n";
-    for (const auto& point : boundary_points) {
-        outfile << point.x << ", " << point.y << ", " << point.z << "\n";
+    if (soup_faces > 0) {
+        std::cerr << "Warning: " << soup_faces << " refined faces could not be stitched and were added unconnected." << std::endl;
     }
+    StatsCount("local_stitch_soup_faces", soup_faces);
+}
 
-    outfile.close();
+/**
+ * 局部共精细化: 只取出包围盒与另一网格的面交叠的面，对取出的面片做共精细化，再拼回各自网格的其余部分，
+ * 时间与内存随交叠区域而不是整个网格增长。
+ * 与另一网格相交的面一定在面片内，因此面片边界上的边和顶点不会被切开，拼接时直接复用原顶点。
+ * constrained2 非空时，mesh2 中的交线边在其中标记为 true (同 edge_is_constrained_map)。
+ * 结束时两个网格都做一次垃圾回收，原有的顶点/面索引失效，属性图随之整理。
+ */
+template <class Kernel>
+void local_corefine(Kernel_mesh<Kernel>& mesh1, Kernel_mesh<Kernel>& mesh2, Kernel_edge_constrained_map<Kernel>* constrained2 = nullptr) {
+    std::vector<Face_index> faces1, faces2;
+    overlapping_faces(mesh1, mesh2, faces1, faces2);
+    StatsCount("local_patch_faces_mesh1", faces1.size());
+    StatsCount("local_patch_faces_mesh2", faces2.size());
+    if (faces1.empty()) return;
+
+    LocalPatch<Kernel> patch1, patch2;
+    extract_patch(mesh1, faces1, patch1);
+    extract_patch(mesh2, faces2, patch2);
+    auto patch_constrained = patch2.mesh.template add_property_map<Edge_index, bool>("e:constrained", false).first;
+    PMP::corefine(patch1.mesh, patch2.mesh, CGAL::parameters::default_values(), CGAL::parameters::edge_is_constrained_map(patch_constrained));
+
+    stitch_patch(mesh1, faces1, patch1);
+    stitch_patch(mesh2, faces2, patch2, &patch_constrained, constrained2);
+    mesh1.collect_garbage();
+    mesh2.collect_garbage();
+}
+
+// 对 mesh1 与 mesh2 做共精细化；local 为 true 时只处理交叠区域 (见 local_corefine)
+template <class Kernel>
+void corefine_meshes(Kernel_mesh<Kernel>& mesh1, Kernel_mesh<Kernel>& mesh2, bool local, Kernel_edge_constrained_map<Kernel>* constrained2 = nullptr) {
+    static_assert(kernel_has_exact_predicates<Kernel>, "corefinement requires a kernel with exact predicates");
+    ScopedTimer timer("corefine");
+    if (local) {
+        local_corefine(mesh1, mesh2, constrained2);
+    } else if (constrained2 != nullptr) {
+        PMP::corefine(mesh1, mesh2, CGAL::parameters::default_values(), CGAL::parameters::edge_is_constrained_map(*constrained2));
+    } else {
+        PMP::corefine(mesh1, mesh2);
+    }
 }
 
-inline void co_refinement(Mesh& mesh1, Mesh& mesh2, const std::string& output1, const std::string& output2) {
+template <class Kernel>
+void co_refinement(Kernel_mesh<Kernel>& mesh1, Kernel_mesh<Kernel>& mesh2, const std::string& output1, const std::string& output2, bool local = false) {
     // 检查输入网格是否是三角网格
     if (!CGAL::is_triangle_mesh(mesh1) || !CGAL::is_triangle_mesh(mesh2)) {
         std::cerr << "Error: Both meshes must be triangle meshes." << std::endl;
@@ -122,112 +274,550 @@ inline void co_refinement(Mesh& mesh1, Mesh& mesh2, const std::string& output1,
     }
 
     // 进行共精细化
-    PMP::corefine(mesh1, mesh2);
+    corefine_meshes(mesh1, mesh2, local);
+    StatsCount("faces_after_corefine_mesh1", mesh1.number_of_faces());
+    StatsCount("faces_after_corefine_mesh2", mesh2.number_of_faces());
 
+    ScopedTimer timer("write_output");
     CGAL::IO::write_polygon_mesh(output1, mesh1, CGAL::parameters::stream_precision(17));
     CGAL::IO::write_polygon_mesh(output2, mesh2, CGAL::parameters::stream_precision(17));
     std::cout << "Co-refinement completed." << std::endl;
 }
 
-inline std::vector<K::Point_3> co_refinement_and_clip(Mesh& mesh1, Mesh& mesh2, const std::string& output1 = "", const std::string& output2 = "") {
-    // 进行共精细化操作
-    PMP::corefine(mesh1, mesh2);
+/**
+ * 对 mesh 的每个顶点做一次点定位，结果存入顶点属性 "v:side"。
+ * constrained 非空时，约束边 (共精细化得到的交线) 上的顶点直接标记为 ON_BOUNDARY，不做点定位。
+ * 顶点按连续区间分给各线程，每个线程使用自己的 Side_of_triangle_mesh，共享同一棵已建好的 AABB 树。
+ */
+template <class Kernel>
+Kernel_vertex_side_map<Kernel> classify_vertices(Kernel_mesh<Kernel>& mesh, const std::type_identity_t<Kernel_face_tree<Kernel>>& tree,
+                                                 unsigned int num_threads = 1,
+                                                 const Kernel_edge_constrained_map<Kernel>* constrained = nullptr) {
+    ScopedTimer timer("classification");
+    auto side = mesh.template add_property_map<Vertex_index, CGAL::Bounded_side>("v:side", CGAL::ON_UNBOUNDED_SIDE).first;
+
+    std::vector<Vertex_index> vertices;
+    if (constrained != nullptr) {
+        for (Edge_index e : mesh.edges()) {
+            if ((*constrained)[e]) {
+                side[mesh.source(mesh.halfedge(e))] = CGAL::ON_BOUNDARY;
+                side[mesh.target(mesh.halfedge(e))] = CGAL::ON_BOUNDARY;
+            }
+        }
+        for (Vertex_index v : mesh.vertices()) {
+            if (side[v] != CGAL::ON_BOUNDARY) vertices.push_back(v);
+        }
+    } else {
+        vertices.assign(mesh.vertices().begin(), mesh.vertices().end());
+    }
+    num_threads = kernel_thread_count<Kernel>(num_threads);
+    const std::vector<std::size_t> bounds = split_range(vertices.size(), num_threads == 1 ? 1 : std::size_t(num_threads) * 8);
+    parallel_for(bounds.size() - 1, num_threads, [&](std::size_t c) {
+        Kernel_point_inside<Kernel> inside(tree);
+        for (std::size_t i = bounds[c]; i < bounds[c + 1]; ++i) {
+            side[vertices[i]] = inside(mesh.point(vertices[i]));
+        }
+    });
+    StatsCount("point_location_queries", vertices.size());
+    return side;
+}
 
-    // 创建一个点在网格内外的检查器
-    CGAL::Side_of_triangle_mesh<Mesh, K> inside(mesh1);
+/**
+ * 按约束边 (交线) 把 mesh 分成若干连通面片，同一面片内的面都在 mesh1 内部或都在外部，
+ * 因此每个面片只取一个面的重心做一次点定位。
+ * 返回面属性 "f:inside": 所在面片位于 mesh1 内部或边界上的面为 1，其余为 0。
+ */
+template <class Kernel>
+Kernel_face_label_map<Kernel> classify_patches(Kernel_mesh<Kernel>& mesh, const std::type_identity_t<Kernel_face_tree<Kernel>>& tree,
+                                               const Kernel_edge_constrained_map<Kernel>& constrained, unsigned int num_threads = 1) {
+    typedef Kernel_mesh<Kernel> Mesh;
+    ScopedTimer timer("classification");
+    auto label = mesh.template add_property_map<Face_index, std::size_t>("f:inside", 0).first;
+    const std::size_t num_patches = PMP::connected_components(mesh, label, CGAL::parameters::edge_is_constrained_map(constrained));
+
+    std::vector<Face_index> representative(num_patches, Mesh::null_face());
+    for (Face_index f : mesh.faces()) {
+        if (representative[label[f]] == Mesh::null_face()) representative[label[f]] = f;
+    }
 
-    // 标记需要删除的面
-    std::vector<Face_index> faces_to_remove;
+    std::vector<char> inside_patch(num_patches, 0);
+    num_threads = kernel_thread_count<Kernel>(num_threads);
+    const std::vector<std::size_t> bounds = split_range(num_patches, num_threads == 1 ? 1 : std::size_t(num_threads) * 8);
+    parallel_for(bounds.size() - 1, num_threads, [&](std::size_t c) {
+        Kernel_point_inside<Kernel> inside(tree);
+        for (std::size_t i = bounds[c]; i < bounds[c + 1]; ++i) {
+            const auto h = mesh.halfedge(representative[i]);
+            const CGAL::Bounded_side side = inside(CGAL::centroid(mesh.point(mesh.target(h)),
+                                                                  mesh.point(mesh.target(mesh.next(h))),
+                                                                  mesh.point(mesh.target(mesh.next(mesh.next(h))))));
+            inside_patch[i] = side == CGAL::ON_BOUNDED_SIDE || side == CGAL::ON_BOUNDARY;
+        }
+    });
 
-    std::vector<K::Point_3> points_in_boundary;
+    for (Face_index f : mesh.faces()) {
+        label[f] = inside_patch[label[f]];
+    }
+    StatsCount("patches", num_patches);
+    StatsCount("point_location_queries", num_patches);
+    return label;
+}
+
+/**
+ * 一次删除 label 为 1 的所有面 (连同因此孤立的边和顶点)，最后做一次垃圾回收，并移除 label 属性。
+ * 返回删除的面数；原有的顶点/边/面索引随垃圾回收失效。
+ */
+template <class Kernel>
+std::size_t remove_labeled_faces(Kernel_mesh<Kernel>& mesh, Kernel_face_label_map<Kernel> label) {
+    ScopedTimer timer("face_removal");
+    std::size_t removed_faces = 0;
+    for (Face_index f : mesh.faces()) {
+        removed_faces += label[f];
+    }
+    if (removed_faces > 0) {
+        PMP::remove_connected_components(mesh, std::vector<std::size_t>(1, 1), label);
+        mesh.collect_garbage();
+    }
+    mesh.remove_property_map(label);
+    StatsCount("faces_removed", removed_faces);
+    return removed_faces;
+}
 
+/**
+ * 根据顶点分类删除 mesh2 中三个顶点都在 mesh1 内部或边界上的面，并移除 side 属性，返回删除的面数。
+ */
+template <class Kernel>
+std::size_t remove_inside_faces(Kernel_mesh<Kernel>& mesh2, Kernel_vertex_side_map<Kernel> side) {
+    auto inside_or_boundary = [&side](Vertex_index v) {
+        return side[v] == CGAL::ON_BOUNDED_SIDE || side[v] == CGAL::ON_BOUNDARY;
+    };
+
+    // 标记需要删除的面: 三个顶点都在mesh1的内部或边界处
+    auto label = mesh2.template add_property_map<Face_index, std::size_t>("f:inside", 0).first;
     for (Face_index f : mesh2.faces()) {
-        // 获取三角形的三个顶点
         const auto h = mesh2.halfedge(f);
-        const K::Point_3& p1 = mesh2.point(mesh2.target(h));
-        const K::Point_3& p2 = mesh2.point(mesh2.target(mesh2.next(h)));
-        const K::Point_3& p3 = mesh2.point(mesh2.target(mesh2.next(mesh2.next(h))));
-
-        // 检查三角形的顶点是否都在mesh1的内部
+        label[f] = inside_or_boundary(mesh2.target(h)) &&
+                   inside_or_boundary(mesh2.target(mesh2.next(h))) &&
+                   inside_or_boundary(mesh2.target(mesh2.next(mesh2.next(h))));
+    }
+    mesh2.remove_property_map(side);
+    return remove_labeled_faces(mesh2, label);
+}
 
-        auto p1_inside_result = inside(p1);
-        auto p2_inside_result = inside(p2);
-        auto p3_inside_result = inside(p3);
+/**
+ * 按 options 选择的分类方式删除 mesh2 中位于裁剪体 (tree) 内部的面，并移除 constrained 属性，返回删除的面数。
+ */
+template <class Kernel>
+std::size_t clip_inside_faces(Kernel_mesh<Kernel>& mesh2, const std::type_identity_t<Kernel_face_tree<Kernel>>& tree,
+                              Kernel_edge_constrained_map<Kernel> constrained, const ClipOptions& options) {
+    if (options.vertex_classification) {
+        auto side = classify_vertices(mesh2, tree, options.num_threads, &constrained);
+        mesh2.remove_property_map(constrained);
+        return remove_inside_faces(mesh2, side);
+    }
+    auto label = classify_patches(mesh2, tree, constrained, options.num_threads);
+    mesh2.remove_property_map(constrained);
+    return remove_labeled_faces(mesh2, label);
+}
 
-        if ((p1_inside_result == CGAL::ON_BOUNDED_SIDE || p1_inside_result == CGAL::ON_BOUNDARY) &&
-            (p2_inside_result == CGAL::ON_BOUNDED_SIDE || p2_inside_result == CGAL::ON_BOUNDARY) &&
-            (p3_inside_result == CGAL::ON_BOUNDED_SIDE || p3_inside_result == CGAL::ON_BOUNDARY)) {
-            faces_to_remove.push_back(f); // 如果全部点都在mesh1的内部或边界处，标记这个面
+// 交线折线: 共精细化后 mesh2 中由约束边依次相连的点
+template <class Kernel>
+struct Boundary_polyline {
+    std::vector<CGAL::Point_3<Kernel>> points;
+    // 首尾相连时为 true，此时首点不在末尾重复
+    bool closed = false;
+};
+typedef Boundary_polyline<K> BoundaryPolyline;
+
+/**
+ * 把 mesh 中的约束边串成有序折线，不做任何几何查询。
+ * 约束度不为 2 的顶点 (端点或多条交线的交汇点) 是开折线的端点，其余约束边组成闭合折线。
+ * points 按折线顺序列出所有交线顶点，每个顶点只出现一次。
+ */
+template <class Kernel>
+std::vector<Boundary_polyline<Kernel>> boundary_polylines(const Kernel_mesh<Kernel>& mesh, const Kernel_edge_constrained_map<Kernel>& constrained,
+                                                          std::vector<CGAL::Point_3<Kernel>>& points) {
+    typedef Kernel_mesh<Kernel> Mesh;
+    std::unordered_map<std::uint32_t, std::uint32_t> degree;
+    std::vector<Edge_index> edges;
+    for (Edge_index e : mesh.edges()) {
+        if (constrained[e]) {
+            edges.push_back(e);
+            ++degree[mesh.source(mesh.halfedge(e)).idx()];
+            ++degree[mesh.target(mesh.halfedge(e)).idx()];
         }
+    }
 
-        if (p1_inside_result == CGAL::ON_BOUNDARY) {
-            points_in_boundary.push_back(p1);
+    std::unordered_set<std::uint32_t> visited_edges;
+    std::unordered_set<std::uint32_t> emitted_vertices;
+    std::vector<Boundary_polyline<Kernel>> polylines;
+    // 从 h 开始沿未访问的约束边前进，直到回到起点或遇到约束度不为 2 的顶点
+    auto walk = [&](typename Mesh::Halfedge_index h) {
+        Boundary_polyline<Kernel> polyline;
+        const Vertex_index start = mesh.source(h);
+        std::vector<Vertex_index> vertices(1, start);
+        while (h != Mesh::null_halfedge()) {
+            visited_edges.insert(mesh.edge(h).idx());
+            const Vertex_index v = mesh.target(h);
+            if (v == start) {
+                polyline.closed = true;
+                break;
+            }
+            vertices.push_back(v);
+            h = Mesh::null_halfedge();
+            if (degree[v.idx()] != 2) break;
+            for (auto next : CGAL::halfedges_around_source(v, mesh)) {
+                if (constrained[mesh.edge(next)] && visited_edges.count(mesh.edge(next).idx()) == 0) {
+                    h = next;
+                    break;
+                }
+            }
         }
-        if (p2_inside_result == CGAL::ON_BOUNDARY) {
-            points_in_boundary.push_back(p2);
+        polyline.points.reserve(vertices.size());
+        for (Vertex_index v : vertices) {
+            polyline.points.push_back(mesh.point(v));
+            if (emitted_vertices.insert(v.idx()).second) points.push_back(mesh.point(v));
         }
-        if (p3_inside_result == CGAL::ON_BOUNDARY) {
-            points_in_boundary.push_back(p3);
+        polylines.push_back(std::move(polyline));
+    };
+
+    for (Edge_index e : edges) {
+        for (Vertex_index v : {mesh.source(mesh.halfedge(e)), mesh.target(mesh.halfedge(e))}) {
+            if (degree[v.idx()] == 2) continue;
+            for (auto h : CGAL::halfedges_around_source(v, mesh)) {
+                if (constrained[mesh.edge(h)] && visited_edges.count(mesh.edge(h).idx()) == 0) walk(h);
+            }
         }
     }
+    for (Edge_index e : edges) {
+        if (visited_edges.count(e.idx()) == 0) walk(mesh.halfedge(e));
+    }
+    StatsCount("boundary_polylines", polylines.size());
+    StatsCount("boundary_points", points.size());
+    return polylines;
+}
 
-    // 删除标记的面
-    for (Face_index f : faces_to_remove) {
-        CGAL::remove_face(f, mesh2);
+/**
+ * 用 mesh1 裁剪 mesh2: 删除 mesh2 中位于 mesh1 内部的面，返回交线上的点 (按折线顺序，每个点一次)。
+ * 交线由共精细化的约束边直接得到，polylines 非空时同时返回有序的交线折线。
+ */
+template <class Kernel>
+std::vector<CGAL::Point_3<Kernel>> co_refinement_and_clip(Kernel_mesh<Kernel>& mesh1, Kernel_mesh<Kernel>& mesh2,
+                                                          const std::string& output1 = "", const std::string& output2 = "",
+                                                          const ClipOptions& options = ClipOptions(),
+                                                          std::vector<Boundary_polyline<Kernel>>* polylines = nullptr) {
+    // 进行共精细化操作，同时记录交线边
+    auto constrained = mesh2.template add_property_map<Edge_index, bool>("e:constrained", false).first;
+    corefine_meshes(mesh1, mesh2, options.local_corefine, &constrained);
+    StatsCount("faces_after_corefine_mesh1", mesh1.number_of_faces());
+    StatsCount("faces_after_corefine_mesh2", mesh2.number_of_faces());
+
+    std::vector<CGAL::Point_3<Kernel>> points_in_boundary;
+    auto boundary = boundary_polylines(mesh2, constrained, points_in_boundary);
+    if (polylines != nullptr) *polylines = std::move(boundary);
+
+    // 创建一个点在网格内外的检查器，每个面片 (或交线以外的每个顶点) 只查询一次
+    Kernel_face_tree<Kernel> tree(faces(mesh1).first, faces(mesh1).second, mesh1);
+    {
+        ScopedTimer timer("build_tree");
+        tree.build();
     }
+    const std::size_t removed_faces = clip_inside_faces(mesh2, tree, constrained, options);
 
+    ScopedTimer timer("write_output");
     if(!output1.empty()) CGAL::IO::write_polygon_mesh(output1, mesh1, CGAL::parameters::stream_precision(17));
     if(!output2.empty()) CGAL::IO::write_polygon_mesh(output2, mesh2, CGAL::parameters::stream_precision(17));
-    std::cout << "Clipping completed, removed " << faces_to_remove.size() << " faces from mesh2." << std::endl;
+    std::cout << "Clipping completed, removed " << removed_faces << " faces from mesh2." << std::endl;
 
     return points_in_boundary;
 }
 
-std::vector<Point3D> ClipMesh(std::vector<Triangle3D>& mesh1, std::vector<Triangle3D>& mesh2)
-{
-    // 将原始三角形构造成CGAL::Surface_Mesh
-    Mesh cgal_mesh1, cgal_mesh2;
-    for (const auto& triangle : mesh1) {
-        Mesh::Vertex_index v0 = cgal_mesh1.add_vertex(K::Point_3(triangle.points[0].x, triangle.points[0].y, triangle.points[0].z));
-        Mesh::Vertex_index v1 = cgal_mesh1.add_vertex(K::Point_3(triangle.points[1].x, triangle.points[1].y, triangle.points[1].z));
-        Mesh::Vertex_index v2 = cgal_mesh1.add_vertex(K::Point_3(triangle.points[2].x, triangle.points[2].y, triangle.points[2].z));
-        cgal_mesh1.add_face(v0, v1, v2);
+// 面 f 的三个顶点坐标
+template <class Kernel>
+Triangle3D face_triangle(const Kernel_mesh<Kernel>& mesh, Face_index f) {
+    const auto h = mesh.halfedge(f);
+    const auto h1 = mesh.next(h);
+    return Triangle3D(to_point3d(mesh.point(mesh.target(h))), to_point3d(mesh.point(mesh.target(h1))),
+                      to_point3d(mesh.point(mesh.target(mesh.next(h1)))));
+}
+
+/**
+ * 预先构造好的裁剪体: 网格本身以及建好的 AABB 树。
+ * 树中保存的是 mesh 的地址，因此对象不可复制或移动。
+ */
+struct ClipCutter {
+    explicit ClipCutter(Mesh cutter_mesh)
+            : mesh(std::move(cutter_mesh))
+            , tree(faces(mesh).first, faces(mesh).second, mesh) {
+        tree.build();
     }
-    for (const auto& triangle : mesh2) {
-        Mesh::Vertex_index v0 = cgal_mesh2.add_vertex(K::Point_3(triangle.points[0].x, triangle.points[0].y, triangle.points[0].z));
-        Mesh::Vertex_index v1 = cgal_mesh2.add_vertex(K::Point_3(triangle.points[1].x, triangle.points[1].y, triangle.points[1].z));
-        Mesh::Vertex_index v2 = cgal_mesh2.add_vertex(K::Point_3(triangle.points[2].x, triangle.points[2].y, triangle.points[2].z));
-        cgal_mesh2.add_face(v0, v1, v2);
+    ClipCutter(const ClipCutter&) = delete;
+    ClipCutter& operator=(const ClipCutter&) = delete;
+
+    Mesh mesh;
+    Face_tree tree;
+};
+
+/**
+ * 用预先构造好的裁剪体裁剪 mesh2，裁剪体本身不被修改，也不整体复制，多个线程可以同时使用同一个 cutter。
+ * 只有包围盒与 mesh2 的面交叠的裁剪体面被复制为面片并与 mesh2 共精细化 (与 mesh2 相交的面一定在其中)，
+ * 其余的面保持原样。refined_cutter 为共精细化后的裁剪体: 未复制的原有面加上共精细化后的面片。
+ * 点定位直接使用 cutter 中已建好的 AABB 树: 共精细化不改变裁剪体的几何形状，而交线顶点由约束边直接得到，
+ * 不依赖舍入后坐标的点定位结果。
+ */
+inline std::vector<K::Point_3> clip_with_cutter(const ClipCutter& cutter, std::vector<Triangle3D>& refined_cutter, Mesh& mesh2,
+                                                const ClipOptions& options = ClipOptions(), std::size_t* removed_faces = nullptr) {
+    std::vector<Face_index> cutter_faces, mesh2_faces;
+    overlapping_faces(cutter.mesh, mesh2, cutter_faces, mesh2_faces);
+    LocalPatch<K> patch;
+    extract_patch(cutter.mesh, cutter_faces, patch);
+    StatsCount("cutter_patch_faces", cutter_faces.size());
+
+    auto constrained = mesh2.add_property_map<Edge_index, bool>("e:constrained", false).first;
+    corefine_meshes(patch.mesh, mesh2, options.local_corefine, &constrained);
+    const std::size_t refined_faces = cutter.mesh.number_of_faces() - cutter_faces.size() + patch.mesh.number_of_faces();
+    StatsCount("faces_after_corefine_mesh1", refined_faces);
+    StatsCount("faces_after_corefine_mesh2", mesh2.number_of_faces());
+
+    std::vector<K::Point_3> points_in_boundary;
+    boundary_polylines(mesh2, constrained, points_in_boundary);
+    const std::size_t removed = clip_inside_faces(mesh2, cutter.tree, constrained, options);
+    if (removed_faces != nullptr) *removed_faces = removed;
+
+    refined_cutter.clear();
+    refined_cutter.reserve(refined_faces);
+    for (Face_index f : cutter.mesh.faces()) {
+        if (!std::binary_search(cutter_faces.begin(), cutter_faces.end(), f)) refined_cutter.push_back(face_triangle(cutter.mesh, f));
     }
+    for (Face_index f : patch.mesh.faces()) {
+        refined_cutter.push_back(face_triangle(patch.mesh, f));
+    }
+    return points_in_boundary;
+}
+
+template <class Kernel>
+void add_triangle_soup(Kernel_mesh<Kernel>& mesh, const Triangle3D& triangle) {
+    Vertex_index v0 = mesh.add_vertex(to_kernel_point<Kernel>(triangle.points[0]));
+    Vertex_index v1 = mesh.add_vertex(to_kernel_point<Kernel>(triangle.points[1]));
+    Vertex_index v2 = mesh.add_vertex(to_kernel_point<Kernel>(triangle.points[2]));
+    mesh.add_face(v0, v1, v2);
+}
+
+/**
+ * 将三角形列表构造成 CGAL::Surface_mesh。
+ * weld_vertices 为 true 时先焊接重合顶点，得到共享顶点和边的索引网格；
+ * 焊接后退化的三角形以及无法以流形方式加入的三角形，仍按原坐标单独加入。
+ */
+template <class Kernel>
+void BuildMesh(const std::vector<Triangle3D>& triangles, Kernel_mesh<Kernel>& mesh, const ClipOptions& options = ClipOptions()) {
+    typedef typename Kernel_mesh<Kernel>::size_type size_type;
+    ScopedTimer timer("build_mesh");
+    if (!options.weld_vertices) {
+        mesh.reserve(static_cast<size_type>(triangles.size() * 3),
+                     static_cast<size_type>(triangles.size() * 3),
+                     static_cast<size_type>(triangles.size()));
+        for (const auto& triangle : triangles) {
+            add_triangle_soup(mesh, triangle);
+        }
+        return;
+    }
+
+    VertexWelder welder(options.weld_tolerance, triangles.size());
+    std::vector<std::array<std::uint32_t, 3>> faces;
+    faces.reserve(triangles.size());
+    for (const auto& triangle : triangles) {
+        faces.push_back({welder.insert(triangle.points[0]), welder.insert(triangle.points[1]), welder.insert(triangle.points[2])});
+    }
+
+    const auto& points = welder.points();
+    // 闭合三角网格的边数约为面数的 1.5 倍
+    mesh.reserve(static_cast<size_type>(points.size()),
+                 static_cast<size_type>(triangles.size() * 3 / 2 + 1),
+                 static_cast<size_type>(triangles.size()));
+    for (const auto& p : points) {
+        mesh.add_vertex(to_kernel_point<Kernel>(p));
+    }
+    for (std::size_t i = 0; i < faces.size(); ++i) {
+        const auto& face = faces[i];
+        if (face[0] != face[1] && face[1] != face[2] && face[2] != face[0] &&
+            mesh.add_face(Vertex_index(face[0]), Vertex_index(face[1]), Vertex_index(face[2])) != Kernel_mesh<Kernel>::null_face()) {
+            continue;
+        }
+        add_triangle_soup(mesh, triangles[i]);
+    }
+}
+
+// 将 CGAL::Surface_mesh 转换为三角形列表
+template <class Kernel>
+void MeshToTriangles(const Kernel_mesh<Kernel>& cgal_mesh, std::vector<Triangle3D>& triangles) {
+    ScopedTimer timer("mesh_to_triangles");
+    auto to_point = [&cgal_mesh](Vertex_index v) {
+        return to_point3d(cgal_mesh.point(v));
+    };
+    triangles.clear();
+    triangles.reserve(cgal_mesh.number_of_faces());
+    for (const auto& f : cgal_mesh.faces()) {
+        const auto h = cgal_mesh.halfedge(f);
+        const auto h1 = cgal_mesh.next(h);
+        triangles.emplace_back(to_point(cgal_mesh.target(h)), to_point(cgal_mesh.target(h1)), to_point(cgal_mesh.target(cgal_mesh.next(h1))));
+    }
+}
+
+/**
+ * 以 Kernel 构造网格并裁剪: mesh1 替换为共精细化后的 mesh1，mesh2 替换为裁剪后的 mesh2，返回交线上的点。
+ */
+template <class Kernel>
+std::vector<Point3D> ClipMesh(std::vector<Triangle3D>& mesh1, std::vector<Triangle3D>& mesh2, const ClipOptions& options)
+{
+    ScopedTimer timer("clip_mesh");
+    StatsCount("input_faces_mesh1", mesh1.size());
+    StatsCount("input_faces_mesh2", mesh2.size());
+
+    // 将原始三角形构造成CGAL::Surface_Mesh
+    Kernel_mesh<Kernel> cgal_mesh1, cgal_mesh2;
+    BuildMesh(mesh1, cgal_mesh1, options);
+    BuildMesh(mesh2, cgal_mesh2, options);
 
     // 进行共精细化和裁剪操作
-    auto boundary_points = co_refinement_and_clip(cgal_mesh1, cgal_mesh2);
+    auto boundary_points = co_refinement_and_clip(cgal_mesh1, cgal_mesh2, "", "", options);
 
     // 将裁剪后的网格转换为三角形列表
     std::vector<Point3D> result;
+    result.reserve(boundary_points.size());
     for (const auto& point : boundary_points) {
-        result.emplace_back(point.x(), point.y(), point.z());
+        result.push_back(to_point3d(point));
     }
     // 修改mesh1和mesh2
-    mesh1.clear();
-    for (const auto& f : cgal_mesh1.faces()) {
-        auto h = cgal_mesh1.halfedge(f);
-        mesh1.emplace_back(
-                Point3D(cgal_mesh1.point(cgal_mesh1.target(h)).x(), cgal_mesh1.point(cgal_mesh1.target(h)).y(), cgal_mesh1.point(cgal_mesh1.target(h)).z()),
-                Point3D(cgal_mesh1.point(cgal_mesh1.target(cgal_mesh1.next(h))).x(), cgal_mesh1.point(cgal_mesh1.target(cgal_mesh1.next(h))).y(), cgal_mesh1.point(cgal_mesh1.target(cgal_mesh1.next(h))).z()),
-                Point3D(cgal_mesh1.point(cgal_mesh1.target(cgal_mesh1.next(cgal_mesh1.next(h)))).x(), cgal_mesh1.point(cgal_mesh1.target(cgal_mesh1.next(cgal_mesh1.next(h)))).y(), cgal_mesh1.point(cgal_mesh1.target(cgal_mesh1.next(cgal_mesh1.next(h)))).z())
-        );
-    }
-    mesh2.clear();
-    for (const auto& f : cgal_mesh2.faces()) {
-        auto h = cgal_mesh2.halfedge(f);
-        mesh2.emplace_back(
-                Point3D(cgal_mesh2.point(cgal_mesh2.target(h)).x(), cgal_mesh2.point(cgal_mesh2.target(h)).y(), cgal_mesh2.point(cgal_mesh2.target(h)).z()),
-                Point3D(cgal_mesh2.point(cgal_mesh2.target(cgal_mesh2.next(h))).x(), cgal_mesh2.point(cgal_mesh2.target(cgal_mesh2.next(h))).y(), cgal_mesh2.point(cgal_mesh2.target(cgal_mesh2.next(h))).z()),
-                Point3D(cgal_mesh2.point(cgal_mesh2.target(cgal_mesh2.next(cgal_mesh2.next(h)))).x(), cgal_mesh2.point(cgal_mesh2.target(cgal_mesh2.next(cgal_mesh2.next(h)))).y(), cgal_mesh2.point(cgal_mesh2.target(cgal_mesh2.next(cgal_mesh2.next(h)))).z())
-        );
-    }
+    MeshToTriangles(cgal_mesh1, mesh1);
+    MeshToTriangles(cgal_mesh2, mesh2);
     return result;
 }
 
+// 按 options.kernel 选择内核 (Float 改用 Epick，见 dispatch_exact_kernel)
+inline std::vector<Point3D> ClipMesh(std::vector<Triangle3D>& mesh1, std::vector<Triangle3D>& mesh2, const ClipOptions& options = ClipOptions())
+{
+    return dispatch_exact_kernel(options.kernel, [&](auto kernel) {
+        return ClipMesh<decltype(kernel)>(mesh1, mesh2, options);
+    });
+}
+
+/**
+ * 由 SoA 缓冲区构造 CGAL::Surface_mesh。输入本身已带索引，因此不再焊接顶点；
+ * 退化的三角形以及无法以流形方式加入的三角形按原坐标单独加入。顶点编号越界时返回 false。
+ */
+template <class Kernel>
+bool BuildMesh(const MeshBufferView& buffers, Kernel_mesh<Kernel>& mesh) {
+    typedef typename Kernel_mesh<Kernel>::size_type size_type;
+    ScopedTimer timer("build_mesh");
+    const std::uint32_t* indices = buffers.indices;
+    for (std::size_t i = 0; i < buffers.num_triangles * 3; ++i) {
+        if (indices[i] >= buffers.num_vertices) {
+            std::cerr << "Error: Triangle " << i / 3 << " references vertex " << indices[i] << " of " << buffers.num_vertices << std::endl;
+            return false;
+        }
+    }
+
+    mesh.reserve(static_cast<size_type>(buffers.num_vertices),
+                 static_cast<size_type>(buffers.num_triangles * 3 / 2 + 1),
+                 static_cast<size_type>(buffers.num_triangles));
+    for (std::size_t v = 0; v < buffers.num_vertices; ++v) {
+        mesh.add_vertex(to_kernel_point<Kernel>(Point3D(buffers.x[v], buffers.y[v], buffers.z[v])));
+    }
+    for (std::size_t t = 0; t < buffers.num_triangles; ++t) {
+        const std::uint32_t* face = indices + t * 3;
+        if (face[0] != face[1] && face[1] != face[2] && face[2] != face[0] &&
+            mesh.add_face(Vertex_index(face[0]), Vertex_index(face[1]), Vertex_index(face[2])) != Kernel_mesh<Kernel>::null_face()) {
+            continue;
+        }
+        // 先复制坐标: add_vertex 可能使点数组重新分配，引用 mesh.point() 会失效
+        const CGAL::Point_3<Kernel> p0 = mesh.point(Vertex_index(face[0]));
+        const CGAL::Point_3<Kernel> p1 = mesh.point(Vertex_index(face[1]));
+        const CGAL::Point_3<Kernel> p2 = mesh.point(Vertex_index(face[2]));
+        const Vertex_index v0 = mesh.add_vertex(p0);
+        const Vertex_index v1 = mesh.add_vertex(p1);
+        const Vertex_index v2 = mesh.add_vertex(p2);
+        mesh.add_face(v0, v1, v2);
+    }
+    return true;
+}
+
+// 将 CGAL::Surface_mesh 写入 SoA 缓冲区，顶点按网格中的顺序紧凑编号，缓冲区的容量只分配一次
+template <class Kernel>
+void MeshToBuffers(const Kernel_mesh<Kernel>& cgal_mesh, MeshBuffers& buffers) {
+    ScopedTimer timer("mesh_to_buffers");
+    const std::size_t num_vertices = cgal_mesh.number_of_vertices();
+    buffers.x.resize(num_vertices);
+    buffers.y.resize(num_vertices);
+    buffers.z.resize(num_vertices);
+    buffers.indices.resize(cgal_mesh.number_of_faces() * 3);
+
+    // 网格中可能有已删除的元素，顶点重新紧凑编号
+    std::vector<std::uint32_t> compact(cgal_mesh.num_vertices());
+    std::uint32_t next = 0;
+    for (Vertex_index v : cgal_mesh.vertices()) {
+        const Point3D p = to_point3d(cgal_mesh.point(v));
+        buffers.x[next] = p.x;
+        buffers.y[next] = p.y;
+        buffers.z[next] = p.z;
+        compact[v.idx()] = next++;
+    }
+    std::uint32_t* out = buffers.indices.data();
+    for (Face_index f : cgal_mesh.faces()) {
+        const auto h = cgal_mesh.halfedge(f);
+        const auto h1 = cgal_mesh.next(h);
+        *out++ = compact[cgal_mesh.target(h).idx()];
+        *out++ = compact[cgal_mesh.target(h1).idx()];
+        *out++ = compact[cgal_mesh.target(cgal_mesh.next(h1)).idx()];
+    }
+}
+
+/**
+ * ClipMesh 的 SoA 版本: 输入为调用方持有的只读视图，结果写入调用方提供的缓冲区
+ * (out1 为共精细化后的 mesh1，out2 为裁剪后的 mesh2，boundary 为交线上的点)。
+ * 输入缓冲区可以是 out1/out2 本身 (先构造网格再写出)。顶点编号越界时返回 false。
+ */
+template <class Kernel>
+bool ClipMesh(const MeshBufferView& mesh1, const MeshBufferView& mesh2, MeshBuffers& out1, MeshBuffers& out2,
+              PointBuffers& boundary, const ClipOptions& options) {
+    ScopedTimer timer("clip_mesh");
+    StatsCount("input_faces_mesh1", mesh1.num_triangles);
+    StatsCount("input_faces_mesh2", mesh2.num_triangles);
+
+    Kernel_mesh<Kernel> cgal_mesh1, cgal_mesh2;
+    if (!BuildMesh(mesh1, cgal_mesh1) || !BuildMesh(mesh2, cgal_mesh2)) {
+        return false;
+    }
+
+    const auto boundary_points = co_refinement_and_clip(cgal_mesh1, cgal_mesh2, "", "", options);
+    boundary.x.resize(boundary_points.size());
+    boundary.y.resize(boundary_points.size());
+    boundary.z.resize(boundary_points.size());
+    for (std::size_t i = 0; i < boundary_points.size(); ++i) {
+        const Point3D p = to_point3d(boundary_points[i]);
+        boundary.x[i] = p.x;
+        boundary.y[i] = p.y;
+        boundary.z[i] = p.z;
+    }
+    MeshToBuffers(cgal_mesh1, out1);
+    MeshToBuffers(cgal_mesh2, out2);
+    return true;
+}
+
+// 按 options.kernel 选择内核 (Float 改用 Epick，见 dispatch_exact_kernel)
+inline bool ClipMesh(const MeshBufferView& mesh1, const MeshBufferView& mesh2, MeshBuffers& out1, MeshBuffers& out2,
+                     PointBuffers& boundary, const ClipOptions& options = ClipOptions()) {
+    return dispatch_exact_kernel(options.kernel, [&](auto kernel) {
+        return ClipMesh<decltype(kernel)>(mesh1, mesh2, out1, out2, boundary, options);
+    });
+}
+
+// Epick 与 Epeck 的裁剪流程在 kernel_instantiations.cpp 中显式实例化
+extern template std::vector<CGAL::Point_3<K>> co_refinement_and_clip<K>(Kernel_mesh<K>&, Kernel_mesh<K>&, const std::string&, const std::string&,
+                                                                        const ClipOptions&, std::vector<Boundary_polyline<K>>*);
+extern template std::vector<CGAL::Point_3<EK>> co_refinement_and_clip<EK>(Kernel_mesh<EK>&, Kernel_mesh<EK>&, const std::string&, const std::string&,
+                                                                          const ClipOptions&, std::vector<Boundary_polyline<EK>>*);
+extern template std::vector<Point3D> ClipMesh<K>(std::vector<Triangle3D>&, std::vector<Triangle3D>&, const ClipOptions&);
+extern template std::vector<Point3D> ClipMesh<EK>(std::vector<Triangle3D>&, std::vector<Triangle3D>&, const ClipOptions&);
+extern template bool ClipMesh<K>(const MeshBufferView&, const MeshBufferView&, MeshBuffers&, MeshBuffers&, PointBuffers&, const ClipOptions&);
+extern template bool ClipMesh<EK>(const MeshBufferView&, const MeshBufferView&, MeshBuffers&, MeshBuffers&, PointBuffers&, const ClipOptions&);
+
 #endif //MESH_INTERSECTION_CO_REFINEMENT_H
@@ -5,127 +5,467 @@
 #ifndef INTERSECTION_LINE_H
 #define INTERSECTION_LINE_H
 
-#include <CGAL/Simple_cartesian.h>
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/Surface_mesh.h>
 #include <CGAL/Polygon_mesh_processing/intersection.h>
 #include <CGAL/IO/PLY.h>
+#include <CGAL/box_intersection_d.h>
+#include <CGAL/Box_intersection_d/Box_with_info_d.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <fstream>
 #include <iostream>
-#include <unordered_set>
-typedef CGAL::Exact_predicates_inexact_constructions_kernel K;
-typedef K::Point_3 Point_3;
-typedef K::Segment_3 Segment_3;
-typedef K::Triangle_3 Triangle_3;
-typedef CGAL::Surface_mesh<Point_3> Mesh;
+#include "examples/kernels.h"
+#include "examples/mesh_data.h"
+#include "examples/parallel.h"
+#include "examples/triangle_prefilter.h"
 namespace PMP = CGAL::Polygon_mesh_processing;
 
-inline bool intersection_line(int argc, char* argv[]) {
-    const std::string filename1 = (argc > 1) ? argv[1] : R"(D:\Code\Data\Plane.ply)";
-    const std::string filename2 = (argc > 2) ? argv[2] : R"(D:\Code\Data\Plane2.ply)";
-    const std::string output_filename = (argc > 3) ? argv[3] : R"(D:\Code\Data\intersection.ply)";
-    // 读取第一个PLY文件
-    Mesh mesh1;
-    std::ifstream input1(filename1, std::ios::binary);
-    if (!input1 || !CGAL::IO::read_PLY(input1, mesh1)) {
-        std::cerr << "Cannot read file " << filename1 << std::endl;
-        return false;
+typedef CGAL::Box_intersection_d::Box_with_info_d<double, 3, Face_index> Face_box;
+
+struct Intersection_line_options {
+    // true: 先用包围盒求出候选面对，再做精确求交；false: 遍历所有面对
+    bool broad_phase = true;
+    // 求交使用的线程数，0 表示使用全部硬件线程
+    unsigned int num_threads = 1;
+    // 以二进制小端格式写 PLY
+    bool binary_ply = false;
+    // 去掉退化边与重复边，边按折线顺序输出
+    bool polylines = false;
+    // 读取网格与求交所用的内核 (见 kernels.h)
+    MeshKernel kernel = MeshKernel::Epick;
+    // 精确求交前先用分离轴测试排除一定不相交的候选面对 (见 triangle_prefilter.h)
+    bool prefilter = true;
+};
+
+/**
+ * 分离轴预筛选只用于 Epick: 其谓词精确、坐标为 double，精确求交的结果不受预筛选影响。
+ * Epeck 的坐标不能无损地转为 double，float 内核的求交本身不精确，两者都直接精确求交。
+ */
+template <class Kernel>
+inline constexpr bool kernel_supports_prefilter = std::is_same_v<Kernel, K>;
+
+template <class Kernel>
+CGAL::Triangle_3<Kernel> face_triangle(const Kernel_mesh<Kernel>& mesh, Face_index f) {
+    const auto h = mesh.halfedge(f);
+    return CGAL::Triangle_3<Kernel>(mesh.point(mesh.target(h)),
+                      mesh.point(mesh.target(mesh.next(h))),
+                      mesh.point(mesh.target(mesh.next(mesh.next(h)))));
+}
+
+// 按面编号收集网格三角形的顶点坐标，供预筛选按批取用
+template <class Kernel>
+TriangleSoA mesh_triangle_soa(const Kernel_mesh<Kernel>& mesh) {
+    TriangleSoA triangles;
+    triangles.resize(mesh.num_faces());
+    for (auto f : mesh.faces()) {
+        std::array<double, 9> vertices;
+        auto h = mesh.halfedge(f);
+        for (std::size_t k = 0; k < 3; ++k, h = mesh.next(h)) {
+            const auto& p = mesh.point(mesh.target(h));
+            vertices[3 * k] = CGAL::to_double(p.x());
+            vertices[3 * k + 1] = CGAL::to_double(p.y());
+            vertices[3 * k + 2] = CGAL::to_double(p.z());
+        }
+        triangles.set(f.idx(), vertices);
     }
+    return triangles;
+}
 
-    // 读取第二个PLY文件
-    Mesh mesh2;
-    std::ifstream input2(filename2, std::ios::binary);
-    if (!input2 || !CGAL::IO::read_PLY(input2, mesh2)) {
-        std::cerr << "Cannot read file " << filename2 << std::endl;
+/**
+ * 求出包围盒相交的所有面对 (face1 属于 mesh1, face2 属于 mesh2)，
+ * 结果按 (face1, face2) 排序，与逐对遍历时的顺序一致。
+ */
+template <class Kernel>
+std::vector<std::pair<Face_index, Face_index>> candidate_face_pairs(const Kernel_mesh<Kernel>& mesh1, const Kernel_mesh<Kernel>& mesh2) {
+    std::vector<Face_box> boxes1, boxes2;
+    boxes1.reserve(mesh1.number_of_faces());
+    boxes2.reserve(mesh2.number_of_faces());
+    for (auto f : mesh1.faces()) {
+        boxes1.emplace_back(face_triangle(mesh1, f).bbox(), f);
+    }
+    for (auto f : mesh2.faces()) {
+        boxes2.emplace_back(face_triangle(mesh2, f).bbox(), f);
+    }
+
+    // 包围盒按闭区间判断相交，只接触于一点的三角形也会被保留
+    std::vector<std::pair<Face_index, Face_index>> pairs;
+    CGAL::box_intersection_d(boxes1.begin(), boxes1.end(), boxes2.begin(), boxes2.end(),
+                             [&pairs](const Face_box& b1, const Face_box& b2) {
+                                 pairs.emplace_back(b1.info(), b2.info());
+                             });
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+template <class Kernel>
+void intersect_triangles(const CGAL::Triangle_3<Kernel>& tri1, const CGAL::Triangle_3<Kernel>& tri2,
+                         std::vector<CGAL::Segment_3<Kernel>>& intersection_segments) {
+    // 计算两个三角形的相交结果
+    auto result = CGAL::intersection(tri1, tri2);
+    if(result) {
+        if (const auto* s = boost::get<CGAL::Segment_3<Kernel>>(&*result)) {
+            intersection_segments.push_back(*s);
+        } else if (const auto* p = boost::get<CGAL::Point_3<Kernel>>(&*result)) {
+            // 如果相交结果是一个点
+            intersection_segments.emplace_back(*p, *p); // 将点处理为长度为零的线段
+        }
+    }
+}
+
+template <class Kernel>
+bool read_ply_mesh(const std::string& filename, Kernel_mesh<Kernel>& mesh) {
+    std::ifstream input(filename, std::ios::binary);
+    if (!input || !CGAL::IO::read_PLY(input, mesh)) {
+        std::cerr << "Cannot read file " << filename << std::endl;
         return false;
     }
+    return true;
+}
 
-    std::unordered_set<Point_3> S;
-    std::vector<Segment_3> intersection_segments;
+/**
+ * 求出 mesh1 与 mesh2 所有面对的交线段 (交于一点时为长度为零的线段)。
+ * mesh1 的面按连续区间分给各线程，每段写入自己的缓冲区，最后按区间顺序合并，
+ * 因此结果与单线程时完全一致。
+ * 候选面对按 TrianglePairBatch::capacity 个一批做分离轴预筛选，只有可能相交的面对按原顺序做精确求交。
+ */
+template <class Kernel>
+std::vector<CGAL::Segment_3<Kernel>> intersection_segments(const Kernel_mesh<Kernel>& mesh1, const Kernel_mesh<Kernel>& mesh2,
+                                                           const Intersection_line_options& options = Intersection_line_options()) {
+    typedef CGAL::Segment_3<Kernel> Segment;
+    typedef CGAL::Triangle_3<Kernel> Triangle;
+    const unsigned int num_threads = kernel_thread_count<Kernel>(options.num_threads);
+    const std::size_t num_chunks = num_threads == 1 ? 1 : std::size_t(num_threads) * 8;
+    std::vector<std::vector<Segment>> chunk_segments;
 
-    // 遍历第一个网格的所有面
-    for (auto face1 : mesh1.faces()) {
-        std::vector<Point_3> points1;
-        for (auto v : CGAL::vertices_around_face(mesh1.halfedge(face1), mesh1)) {
-            points1.push_back(mesh1.point(v));
+    if (options.broad_phase) {
+        // 只对包围盒相交的面对做精确求交
+        const auto pairs = candidate_face_pairs(mesh1, mesh2);
+        // 区间边界对齐到 face1 的分组处
+        std::vector<std::size_t> bounds = split_range(pairs.size(), num_chunks);
+        for (std::size_t c = 1; c + 1 < bounds.size(); ++c) {
+            std::size_t& b = bounds[c];
+            b = std::max(b, bounds[c - 1]);
+            while (b > 0 && b < pairs.size() && pairs[b].first == pairs[b - 1].first) ++b;
         }
-//        for(auto &p : points1) {
-//            std::cout << p << "\n";
-//        }
-        Triangle_3 tri1(points1[0], points1[1], points1[2]);
-
-        // 遍历第二个网格的所有面
-        for (auto face2 : mesh2.faces()) {
-            std::vector<Point_3> points2;
-            for (auto v : CGAL::vertices_around_face(mesh2.halfedge(face2), mesh2)) {
-                points2.push_back(mesh2.point(v));
+        chunk_segments.resize(bounds.size() - 1);
+
+        bool prefilter = false;
+        TriangleSoA triangles1, triangles2;
+        if constexpr (kernel_supports_prefilter<Kernel>) {
+            prefilter = options.prefilter;
+            if (prefilter) {
+                triangles1 = mesh_triangle_soa(mesh1);
+                triangles2 = mesh_triangle_soa(mesh2);
             }
-//            for(auto &p : points2) {
-//                std::cout << p << "\n";
-//            }
-            Triangle_3 tri2(points2[0], points2[1], points2[2]);
-
-            // 计算两个三角形的相交结果
-            auto result = CGAL::intersection(tri1, tri2);
-            if(result) {
-                if (const Segment_3* s = boost::get<Segment_3>(&*result)) {
-                    intersection_segments.push_back(*s);
-                } else if (const Point_3* p = boost::get<Point_3>(&*result)) {
-                    // 如果相交结果是一个点
-                    intersection_segments.emplace_back(*p, *p); // 将点处理为长度为零的线段
+        }
+        parallel_for(chunk_segments.size(), num_threads, [&](std::size_t c) {
+            TrianglePairBatch batch;
+            std::uint8_t keep[TrianglePairBatch::capacity];
+            std::fill(std::begin(keep), std::end(keep), std::uint8_t(1));
+            // 同一 face1 的三角形只构造一次
+            Face_index face1;
+            Triangle tri1;
+            for (std::size_t begin = bounds[c]; begin < bounds[c + 1]; begin += TrianglePairBatch::capacity) {
+                const std::size_t count = std::min(TrianglePairBatch::capacity, bounds[c + 1] - begin);
+                if (prefilter) {
+                    for (std::size_t j = 0; j < count; ++j) {
+                        batch.set(j, triangles1, pairs[begin + j].first.idx(), triangles2, pairs[begin + j].second.idx());
+                    }
+                    triangle_pairs_may_intersect(batch, count, keep);
                 }
+                for (std::size_t j = 0; j < count; ++j) {
+                    if (!keep[j]) continue;
+                    const auto& pair = pairs[begin + j];
+                    if (pair.first != face1) {
+                        face1 = pair.first;
+                        tri1 = face_triangle(mesh1, face1);
+                    }
+                    intersect_triangles(tri1, face_triangle(mesh2, pair.second), chunk_segments[c]);
+                }
+            }
+        });
+    } else {
+        const std::vector<Face_index> faces1(mesh1.faces().begin(), mesh1.faces().end());
+        const std::vector<std::size_t> bounds = split_range(faces1.size(), num_chunks);
+        chunk_segments.resize(bounds.size() - 1);
+        parallel_for(chunk_segments.size(), num_threads, [&](std::size_t c) {
+            // 遍历第一个网格的面
+            for (std::size_t i = bounds[c]; i < bounds[c + 1]; ++i) {
+                const Triangle tri1 = face_triangle(mesh1, faces1[i]);
+                // 遍历第二个网格的所有面
+                for (auto face2 : mesh2.faces()) {
+                    intersect_triangles(tri1, face_triangle(mesh2, face2), chunk_segments[c]);
+                }
+            }
+        });
+    }
+
+    std::size_t num_segments = 0;
+    for (const auto& segments : chunk_segments) {
+        num_segments += segments.size();
+    }
+    std::vector<Segment> segments;
+    segments.reserve(num_segments);
+    for (auto& chunk : chunk_segments) {
+        segments.insert(segments.end(), chunk.begin(), chunk.end());
+        std::vector<Segment>().swap(chunk);
+    }
+    return segments;
+}
+
+// 带索引的交线: 去重后的顶点，以及以顶点编号表示的边
+struct Intersection_curve {
+    std::vector<Point3D> vertices;
+    std::vector<std::array<std::uint32_t, 2>> edges;
+};
+
+/**
+ * 对线段端点做一次哈希去重 (坐标完全相同的点合并)，顶点按首次出现的顺序编号，
+ * 每条线段对应一条边，与逐段写出时的编号一致。
+ */
+template <class Kernel>
+Intersection_curve index_segments(const std::vector<CGAL::Segment_3<Kernel>>& segments) {
+    Intersection_curve curve;
+    VertexWelder welder(0.0, segments.size() * 2);
+    curve.edges.reserve(segments.size());
+    for (const auto& seg : segments) {
+        const std::uint32_t source = welder.insert(to_point3d(seg.source()));
+        const std::uint32_t target = welder.insert(to_point3d(seg.target()));
+        curve.edges.push_back({source, target});
+    }
+    curve.vertices = welder.points();
+    return curve;
+}
+
+// 由交线边依次相连的顶点编号；closed 为 true 时首尾相连，首顶点不在末尾重复
+struct Intersection_polyline {
+    std::vector<std::uint32_t> vertices;
+    bool closed = false;
+};
+
+/**
+ * 把交线边串成有序折线，先去掉退化边 (两端为同一顶点) 与重复边。
+ * 度不为 2 的顶点 (端点或分叉点) 是开折线的端点，其余边组成闭合折线。
+ */
+inline std::vector<Intersection_polyline> chain_polylines(const Intersection_curve& curve) {
+    std::vector<std::array<std::uint32_t, 2>> edges;
+    edges.reserve(curve.edges.size());
+    for (const auto& edge : curve.edges) {
+        if (edge[0] != edge[1]) edges.push_back({std::min(edge[0], edge[1]), std::max(edge[0], edge[1])});
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    // 压缩邻接表: 顶点 v 的邻边为 incident[offsets[v], offsets[v + 1])
+    const std::size_t num_vertices = curve.vertices.size();
+    std::vector<std::uint32_t> offsets(num_vertices + 1, 0);
+    for (const auto& edge : edges) {
+        ++offsets[edge[0] + 1];
+        ++offsets[edge[1] + 1];
+    }
+    for (std::size_t v = 0; v < num_vertices; ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<std::uint32_t> incident(offsets.back());
+    std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (std::uint32_t e = 0; e < edges.size(); ++e) {
+        incident[fill[edges[e][0]]++] = e;
+        incident[fill[edges[e][1]]++] = e;
+    }
+    auto degree = [&offsets](std::uint32_t v) { return offsets[v + 1] - offsets[v]; };
+
+    std::vector<char> visited(edges.size(), 0);
+    std::vector<Intersection_polyline> polylines;
+    // 从 start 沿边 e 前进，直到回到起点或遇到度不为 2 的顶点
+    auto walk = [&](std::uint32_t start, std::uint32_t e) {
+        Intersection_polyline polyline;
+        polyline.vertices.push_back(start);
+        std::uint32_t v = start;
+        for (;;) {
+            visited[e] = 1;
+            v = edges[e][0] == v ? edges[e][1] : edges[e][0];
+            if (v == start) {
+                polyline.closed = true;
+                break;
             }
+            polyline.vertices.push_back(v);
+            if (degree(v) != 2) break;
+            const std::uint32_t* first = incident.data() + offsets[v];
+            const std::uint32_t next = visited[first[0]] ? first[1] : first[0];
+            if (visited[next]) break;
+            e = next;
+        }
+        polylines.push_back(std::move(polyline));
+    };
 
+    for (std::uint32_t v = 0; v < num_vertices; ++v) {
+        if (degree(v) == 0 || degree(v) == 2) continue;
+        for (std::uint32_t k = offsets[v]; k < offsets[v + 1]; ++k) {
+            if (!visited[incident[k]]) walk(v, incident[k]);
         }
     }
+    for (std::uint32_t e = 0; e < edges.size(); ++e) {
+        if (!visited[e]) walk(edges[e][0], e);
+    }
+    return polylines;
+}
 
-    // 写入 PLY 文件
+/**
+ * 写出交线 PLY (vertex 与 edge 两个元素)。
+ * binary 为 false 时为 ASCII 格式，坐标格式与 operator<< 的默认格式相同；
+ * 为 true 时为二进制小端格式，坐标为 float32，顶点编号为 int32。
+ */
+inline bool write_intersection_ply(const std::string& output_filename, const Intersection_curve& curve, bool binary = false) {
+    static_assert(std::endian::native == std::endian::little, "binary PLY output is little-endian");
     std::ofstream output(output_filename, std::ios::binary);
     if (!output) {
         std::cerr << "Cannot open file " << output_filename << " for writing." << std::endl;
         return false;
     }
 
-    for(auto &seg : intersection_segments) {
-        S.insert(seg.source());
-        S.insert(seg.target());
-    }
     // 写入 PLY 头
-    output << "ply\n";
-    output << "format ascii 1.0\n";
-    output << "element vertex " << S.size() << "\n";
-    output << "property float x\n";
-    output << "property float y\n";
-    output << "property float z\n";
-    output << "element edge " << intersection_segments.size() << "\n";
-    output << "property int vertex1\n";
-    output << "property int vertex2\n";
-    output << "end_header\n";
-
-    // 写入顶点
-    std::map<Point_3, int> vertex_map;
-    int vertex_index = 0;
-    for (const auto& seg : intersection_segments) {
-        if (vertex_map.find(seg.source()) == vertex_map.end()) {
-            vertex_map[seg.source()] = vertex_index++;
-            output << seg.source().x() << " " << seg.source().y() << " " << seg.source().z() << "\n";
+    std::string buffer;
+    buffer += "ply\n";
+    buffer += binary ? "format binary_little_endian 1.0\n" : "format ascii 1.0\n";
+    buffer += "element vertex " + std::to_string(curve.vertices.size()) + "\n";
+    buffer += "property float x\n";
+    buffer += "property float y\n";
+    buffer += "property float z\n";
+    buffer += "element edge " + std::to_string(curve.edges.size()) + "\n";
+    buffer += "property int vertex1\n";
+    buffer += "property int vertex2\n";
+    buffer += "end_header\n";
+
+    if (binary) {
+        const std::size_t header_size = buffer.size();
+        buffer.resize(header_size + curve.vertices.size() * 3 * sizeof(float) + curve.edges.size() * 2 * sizeof(std::int32_t));
+        char* out = buffer.data() + header_size;
+        for (const auto& p : curve.vertices) {
+            const float xyz[3] = {static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(p.z)};
+            std::memcpy(out, xyz, sizeof(xyz));
+            out += sizeof(xyz);
+        }
+        for (const auto& edge : curve.edges) {
+            const std::int32_t ends[2] = {static_cast<std::int32_t>(edge[0]), static_cast<std::int32_t>(edge[1])};
+            std::memcpy(out, ends, sizeof(ends));
+            out += sizeof(ends);
         }
-        if (vertex_map.find(seg.target()) == vertex_map.end()) {
-            vertex_map[seg.target()] = vertex_index++;
-            output << seg.target().x() << " " << seg.target().y() << " " << seg.target().z() << "\n";
+    } else {
+        buffer.reserve(buffer.size() + curve.vertices.size() * 40 + curve.edges.size() * 16);
+        for (const auto& p : curve.vertices) {
+            append_text_double(buffer, p.x);
+            buffer += ' ';
+            append_text_double(buffer, p.y);
+            buffer += ' ';
+            append_text_double(buffer, p.z);
+            buffer += '\n';
+        }
+        char digits[16];
+        for (const auto& edge : curve.edges) {
+            buffer.append(digits, std::to_chars(digits, digits + sizeof(digits), edge[0]).ptr);
+            buffer += ' ';
+            buffer.append(digits, std::to_chars(digits, digits + sizeof(digits), edge[1]).ptr);
+            buffer += '\n';
         }
     }
 
-    // 写入边（线段）
-    for (const auto& seg : intersection_segments) {
-        output << vertex_map[seg.source()] << " " << vertex_map[seg.target()] << "\n";
+    output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!output) {
+        std::cerr << "Failed to write file " << output_filename << std::endl;
+        return false;
     }
+    return true;
+}
 
-    output.close();
-    std::cout << "Intersection segments written to " << output_filename << std::endl;
+template <class Kernel>
+bool intersection_line(const Kernel_mesh<Kernel>& mesh1, const Kernel_mesh<Kernel>& mesh2, const std::string& output_filename,
+                       const Intersection_line_options& options = Intersection_line_options()) {
+    const auto segments = intersection_segments(mesh1, mesh2, options);
+    Intersection_curve curve = index_segments(segments);
 
+    if (options.polylines) {
+        // 按折线顺序重新排列边: 每条折线的边依次相连，闭合折线最后一条边回到起点
+        std::vector<std::array<std::uint32_t, 2>> edges;
+        for (const auto& polyline : chain_polylines(curve)) {
+            for (std::size_t i = 0; i + 1 < polyline.vertices.size(); ++i) {
+                edges.push_back({polyline.vertices[i], polyline.vertices[i + 1]});
+            }
+            if (polyline.closed) edges.push_back({polyline.vertices.back(), polyline.vertices.front()});
+        }
+        curve.edges = std::move(edges);
+    }
+
+    // 写入 PLY 文件
+    if (!write_intersection_ply(output_filename, curve, options.binary_ply)) {
+        return false;
+    }
+    std::cout << "Intersection segments written to " << output_filename << std::endl;
     return true;
 }
 
+// 按 options.kernel 选择内核读取两个 PLY 文件并求交线
+inline bool intersection_line(const std::string& filename1, const std::string& filename2, const std::string& output_filename,
+                              const Intersection_line_options& options = Intersection_line_options()) {
+    return dispatch_kernel(options.kernel, [&](auto kernel) {
+        // 读取两个PLY文件
+        Kernel_mesh<decltype(kernel)> mesh1, mesh2;
+        if (!read_ply_mesh(filename1, mesh1) || !read_ply_mesh(filename2, mesh2)) {
+            return false;
+        }
+        return intersection_line(mesh1, mesh2, output_filename, options);
+    });
+}
+
+/**
+ * 命令行入口: <mesh1.ply> <mesh2.ply> <output.ply> [--all-pairs] [--no-prefilter] [--threads=N] [--binary] [--polylines] [--kernel=NAME]
+ * --all-pairs 关闭包围盒过滤，逐对求交（用于对照结果）
+ * --no-prefilter 关闭分离轴预筛选，所有候选面对都做精确求交（用于对照结果）
+ * --threads=N 求交使用的线程数，0 表示使用全部硬件线程
+ * --binary    以二进制小端格式写 PLY
+ * --polylines 去掉退化边与重复边，边按折线顺序输出
+ * --kernel=NAME  epick (默认)、epeck 或 float，见 kernels.h
+ */
+inline bool intersection_line(int argc, char* argv[]) {
+    std::vector<std::string> files;
+    Intersection_line_options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--all-pairs") {
+            options.broad_phase = false;
+        } else if (arg == "--no-prefilter") {
+            options.prefilter = false;
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            options.num_threads = static_cast<unsigned int>(std::stoul(arg.substr(10)));
+        } else if (arg == "--binary") {
+            options.binary_ply = true;
+        } else if (arg == "--polylines") {
+            options.polylines = true;
+        } else if (arg.rfind("--kernel=", 0) == 0) {
+            if (!ParseMeshKernel(arg.substr(9), options.kernel)) {
+                std::cerr << "Error: Unknown kernel " << arg.substr(9) << std::endl;
+                return false;
+            }
+        } else {
+            files.push_back(arg);
+        }
+    }
+    const std::string filename1 = (files.size() > 0) ? files[0] : R"(D:\Code\Data\Plane.ply)";
+    const std::string filename2 = (files.size() > 1) ? files[1] : R"(D:\Code\Data\Plane2.ply)";
+    const std::string output_filename = (files.size() > 2) ? files[2] : R"(D:\Code\Data\intersection.ply)";
+    return intersection_line(filename1, filename2, output_filename, options);
+}
+
+// 三种内核的求交流程在 kernel_instantiations.cpp 中显式实例化
+extern template std::vector<CGAL::Segment_3<K>> intersection_segments<K>(const Kernel_mesh<K>&, const Kernel_mesh<K>&, const Intersection_line_options&);
+extern template std::vector<CGAL::Segment_3<EK>> intersection_segments<EK>(const Kernel_mesh<EK>&, const Kernel_mesh<EK>&, const Intersection_line_options&);
+extern template std::vector<CGAL::Segment_3<FK>> intersection_segments<FK>(const Kernel_mesh<FK>&, const Kernel_mesh<FK>&, const Intersection_line_options&);
+
 #endif //INTERSECTION_LINE_H
@@ -0,0 +1,130 @@
+//
+// Created by RainSure on 24-10-18.
+//
+
+#ifndef MESH_INTERSECTION_KERNELS_H
+#define MESH_INTERSECTION_KERNELS_H
+
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <CGAL/Surface_mesh.h>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include "examples/mesh_data.h"
+
+/**
+ * 各算法共用的内核与网格类型。裁剪、共精细化与求交的流程以内核为模板参数，支持以下三种内核:
+ *   K   Epick: 精确谓词、浮点构造，默认内核
+ *   EK  Epeck: 精确谓词、精确构造，最稳健，速度最慢、内存最大
+ *   FK  Simple_cartesian<float>: 坐标以 float 存储，内存最小，谓词不精确，只用于求交线 (intersection_line)
+ * 共精细化、裁剪与布尔运算要求精确谓词，只支持 K 与 EK (见 kernel_has_exact_predicates)。
+ * 网格类型 Kernel_mesh<Kernel> 的点类型为 CGAL::Point_3<Kernel>，模板函数由网格参数推导内核。
+ */
+typedef CGAL::Exact_predicates_inexact_constructions_kernel K;
+typedef CGAL::Exact_predicates_exact_constructions_kernel EK;
+typedef CGAL::Simple_cartesian<float> FK;
+
+template <class Kernel>
+using Kernel_mesh = CGAL::Surface_mesh<CGAL::Point_3<Kernel>>;
+
+typedef K::Point_3 Point_3;
+typedef K::Segment_3 Segment_3;
+typedef K::Triangle_3 Triangle_3;
+typedef Kernel_mesh<K> Mesh;
+typedef Mesh::Vertex_index Vertex_index;
+typedef Mesh::Edge_index Edge_index;
+typedef Mesh::Face_index Face_index;
+
+// 命令行可选的内核
+enum class MeshKernel {
+    Epick,
+    Epeck,
+    Float,
+};
+
+// 解析 "epick"、"epeck" 或 "float"
+inline bool ParseMeshKernel(const std::string& name, MeshKernel& kernel) {
+    if (name == "epick") {
+        kernel = MeshKernel::Epick;
+    } else if (name == "epeck") {
+        kernel = MeshKernel::Epeck;
+    } else if (name == "float") {
+        kernel = MeshKernel::Float;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 共精细化、裁剪与布尔运算可用的内核 (见 kernel_has_exact_predicates)
+inline bool IsCorefinementKernel(MeshKernel kernel) {
+    return kernel != MeshKernel::Float;
+}
+
+/**
+ * 按运行时选择的内核调用 function(Kernel())，在编译期为每种内核各实例化一次，各分支的返回类型须相同。
+ */
+template <class Function>
+decltype(auto) dispatch_kernel(MeshKernel kernel, Function&& function) {
+    switch (kernel) {
+        case MeshKernel::Epeck:
+            return function(EK());
+        case MeshKernel::Float:
+            return function(FK());
+        case MeshKernel::Epick:
+            break;
+    }
+    return function(K());
+}
+
+/**
+ * 与 dispatch_kernel 相同，但只选择具有精确谓词的内核 (共精细化、裁剪与布尔运算)。
+ * 选择 Float 时给出警告并改用 Epick。
+ */
+template <class Function>
+decltype(auto) dispatch_exact_kernel(MeshKernel kernel, Function&& function) {
+    switch (kernel) {
+        case MeshKernel::Epeck:
+            return function(EK());
+        case MeshKernel::Float:
+            std::cerr << "Warning: The float kernel has inexact predicates and cannot be used for corefinement, using epick" << std::endl;
+            break;
+        case MeshKernel::Epick:
+            break;
+    }
+    return function(K());
+}
+
+/**
+ * PMP::corefine 假定谓词精确: 谓词不精确时，几乎重合或几乎共面的输入会得到自相交或不一致的结果，甚至无法结束。
+ */
+template <class Kernel>
+inline constexpr bool kernel_has_exact_predicates = !std::is_same_v<Kernel, FK>;
+
+/**
+ * Epeck 的点是惰性求值的共享对象，多个线程同时求值同一个点不安全，
+ * 因此该内核的并行阶段固定使用单线程。
+ */
+template <class Kernel>
+inline constexpr bool kernel_supports_threads = !std::is_same_v<Kernel, EK>;
+
+template <class Kernel>
+inline unsigned int kernel_thread_count(unsigned int num_threads) {
+    return kernel_supports_threads<Kernel> ? resolve_thread_count(num_threads) : 1;
+}
+
+// Point3D 与内核点类型之间的转换；Epick 下不改变坐标
+template <class Kernel>
+inline CGAL::Point_3<Kernel> to_kernel_point(const Point3D& p) {
+    typedef typename Kernel::FT FT;
+    return CGAL::Point_3<Kernel>(FT(p.x), FT(p.y), FT(p.z));
+}
+
+template <class Kernel>
+inline Point3D to_point3d(const CGAL::Point_3<Kernel>& p) {
+    return Point3D(CGAL::to_double(p.x()), CGAL::to_double(p.y()), CGAL::to_double(p.z()));
+}
+
+#endif //MESH_INTERSECTION_KERNELS_H
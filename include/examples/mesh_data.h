@@ -0,0 +1,450 @@
+//
+// Created by RainSure on 24-9-24.
+//
+
+#ifndef MESH_INTERSECTION_MESH_DATA_H
+#define MESH_INTERSECTION_MESH_DATA_H
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "examples/mapped_file.h"
+#include "examples/parallel.h"
+#include "examples/stats.h"
+
+struct Point3D{
+    Point3D() = default;
+    Point3D(double x, double y, double z) : x(x), y(y), z(z) {}
+    double x, y, z;
+};
+
+struct Triangle3D {
+    Triangle3D() = default;
+    Triangle3D(const std::array<Point3D, 3>& points) : points(points) {}
+    Triangle3D(const Point3D& p1, const Point3D& p2, const Point3D& p3) : points({p1, p2, p3}) {}
+    std::array<Point3D, 3> points;
+};
+
+struct MeshData {
+    std::vector<Triangle3D> triangles;
+};
+
+/**
+ * 结构数组 (SoA) 形式的三角网格的只读视图: 连续的 x/y/z 坐标数组，以及每个三角形 3 个顶点编号的数组。
+ * 视图不拥有数据，调用方的数组不会被复制。
+ */
+struct MeshBufferView {
+    const double* x = nullptr;
+    const double* y = nullptr;
+    const double* z = nullptr;
+    std::size_t num_vertices = 0;
+    const std::uint32_t* indices = nullptr;
+    std::size_t num_triangles = 0;
+};
+
+// 由调用方提供的点输出缓冲区，重复使用同一对象可以复用已分配的容量
+struct PointBuffers {
+    std::vector<double> x, y, z;
+};
+
+// 由调用方提供的网格输出缓冲区，indices 中每 3 个编号为一个三角形
+struct MeshBuffers : PointBuffers {
+    std::vector<std::uint32_t> indices;
+
+    MeshBufferView view() const {
+        return {x.data(), y.data(), z.data(), x.size(), indices.data(), indices.size() / 3};
+    }
+};
+
+/**
+ * 基于空间哈希的顶点焊接。
+ * tolerance > 0 时以 tolerance 为网格边长，在相邻的 27 个格子中查找距离不超过 tolerance 的已有顶点；
+ * tolerance == 0 时直接以坐标的位模式为键，只合并完全相同的点。
+ * 合并后的顶点坐标取第一次出现的点。
+ */
+class VertexWelder {
+public:
+    explicit VertexWelder(double tolerance = 0.0, std::size_t expected_points = 0)
+            : tolerance_(tolerance > 0.0 ? tolerance : 0.0)
+            , inv_cell_size_(tolerance > 0.0 ? 1.0 / tolerance : 0.0) {
+        points_.reserve(expected_points);
+        next_.reserve(expected_points);
+        heads_.reserve(expected_points);
+    }
+
+    // 返回点 p 对应的顶点编号，新的点追加到 points() 末尾
+    std::uint32_t insert(const Point3D& p) {
+        const CellKey cell = cell_of(p);
+        if (tolerance_ == 0.0) {
+            const std::uint32_t found = find_in_cell(cell, p);
+            if (found != npos) return found;
+        } else {
+            for (std::int64_t dx = -1; dx <= 1; ++dx) {
+                for (std::int64_t dy = -1; dy <= 1; ++dy) {
+                    for (std::int64_t dz = -1; dz <= 1; ++dz) {
+                        const std::uint32_t found = find_in_cell({cell.x + dx, cell.y + dy, cell.z + dz}, p);
+                        if (found != npos) return found;
+                    }
+                }
+            }
+        }
+
+        const auto index = static_cast<std::uint32_t>(points_.size());
+        points_.push_back(p);
+        auto it = heads_.find(cell);
+        if (it == heads_.end()) {
+            next_.push_back(npos);
+            heads_.emplace(cell, index);
+        } else {
+            next_.push_back(it->second);
+            it->second = index;
+        }
+        return index;
+    }
+
+    const std::vector<Point3D>& points() const { return points_; }
+
+private:
+    static constexpr std::uint32_t npos = static_cast<std::uint32_t>(-1);
+
+    struct CellKey {
+        std::int64_t x, y, z;
+        bool operator==(const CellKey& other) const { return x == other.x && y == other.y && z == other.z; }
+    };
+
+    struct CellKeyHash {
+        std::size_t operator()(const CellKey& key) const {
+            std::uint64_t h = static_cast<std::uint64_t>(key.x) * 0x9E3779B97F4A7C15ull;
+            h ^= static_cast<std::uint64_t>(key.y) + 0x7F4A7C159E3779B9ull + (h << 6) + (h >> 2);
+            h ^= static_cast<std::uint64_t>(key.z) + 0x94D049BB133111EBull + (h << 6) + (h >> 2);
+            return static_cast<std::size_t>(h);
+        }
+    };
+
+    static std::int64_t bits_of(double v) {
+        v += 0.0; // -0.0 与 0.0 视为同一个坐标
+        std::int64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return bits;
+    }
+
+    std::int64_t cell_coordinate(double v) const {
+        const double c = std::floor(v * inv_cell_size_);
+        constexpr double limit = 4.0e18;
+        return static_cast<std::int64_t>(c < -limit ? -limit : (c > limit ? limit : c));
+    }
+
+    CellKey cell_of(const Point3D& p) const {
+        if (tolerance_ == 0.0) return {bits_of(p.x), bits_of(p.y), bits_of(p.z)};
+        return {cell_coordinate(p.x), cell_coordinate(p.y), cell_coordinate(p.z)};
+    }
+
+    std::uint32_t find_in_cell(const CellKey& cell, const Point3D& p) const {
+        const auto it = heads_.find(cell);
+        if (it == heads_.end()) return npos;
+        const double tolerance2 = tolerance_ * tolerance_;
+        for (std::uint32_t i = it->second; i != npos; i = next_[i]) {
+            const Point3D& q = points_[i];
+            const double dx = q.x - p.x, dy = q.y - p.y, dz = q.z - p.z;
+            if (dx * dx + dy * dy + dz * dz <= tolerance2) return i;
+        }
+        return npos;
+    }
+
+    double tolerance_;
+    double inv_cell_size_;
+    std::vector<Point3D> points_;
+    // 同一格子中的顶点用 next_ 串成链表，heads_ 保存每个格子的链表头
+    std::vector<std::uint32_t> next_;
+    std::unordered_map<CellKey, std::uint32_t, CellKeyHash> heads_;
+};
+
+// 一段文本解析出的点，以及段内出现的 mesh1/mesh2 标记
+struct TextChunk {
+    std::vector<Point3D> points;
+    // (标记出现时 points 的大小, 是否为 mesh1)
+    std::vector<std::pair<std::size_t, bool>> markers;
+    bool ok = true;
+    std::string error_line;
+};
+
+// 与 isspace 在 "C" locale 下一致
+inline bool is_text_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+/**
+ * 从 [first, last) 解析一个 double，行为与 sscanf 的 %lf 一致: 跳过前导空白、允许前导 '+'。
+ * 成功时返回数字之后的位置，失败时返回 nullptr。
+ */
+inline const char* parse_text_double(const char* first, const char* last, double& value) {
+    while (first != last && is_text_space(*first)) ++first;
+    const char* number = first;
+    if (first != last && *first == '+') {
+        ++first;
+        if (first != last && (*first == '-' || *first == '+')) return nullptr;
+    }
+    auto [end, ec] = std::from_chars(first, last, value);
+    if (ec == std::errc::result_out_of_range || (ec == std::errc() && end != last && (*end == 'x' || *end == 'X'))) {
+        // 溢出/下溢与十六进制浮点数很少见，交给 strtod 处理
+        const std::string token(number, last);
+        char* token_end = nullptr;
+        value = std::strtod(token.c_str(), &token_end);
+        return number + (token_end - token.c_str());
+    }
+    return ec == std::errc() ? end : nullptr;
+}
+
+inline void parse_text_chunk(const char* first, const char* last, TextChunk& chunk) {
+    // 每行至少 6 个字符 ("x y z\n")，据此预留空间
+    chunk.points.reserve(static_cast<std::size_t>(last - first) / 6 / 4);
+    while (first != last) {
+        const char* line_end = static_cast<const char*>(std::memchr(first, '\n', static_cast<std::size_t>(last - first)));
+        if (line_end == nullptr) line_end = last;
+        const char* next = line_end == last ? last : line_end + 1;
+
+        // 去掉前后的空格
+        const char* begin = first;
+        const char* end = line_end;
+        while (begin != end && (*begin == ' ' || *begin == '\t' || *begin == '\r')) ++begin;
+        while (end != begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) --end;
+        const std::string_view line(begin, static_cast<std::size_t>(end - begin));
+
+        if (line == "mesh1") {
+            chunk.markers.emplace_back(chunk.points.size(), true);
+        } else if (line == "mesh2") {
+            chunk.markers.emplace_back(chunk.points.size(), false);
+        } else if (!line.empty()) {
+            // 直接读取 x, y, z
+            Point3D p;
+            const char* cursor = parse_text_double(begin, end, p.x);
+            if (cursor != nullptr) cursor = parse_text_double(cursor, end, p.y);
+            if (cursor != nullptr) cursor = parse_text_double(cursor, end, p.z);
+            if (cursor == nullptr) {
+                chunk.ok = false;
+                chunk.error_line.assign(line);
+                return;
+            }
+            chunk.points.push_back(p);
+        }
+        first = next;
+    }
+}
+
+/**
+ * 读取文本格式的 mesh1/mesh2。
+ * 文件以内存映射方式打开，按换行切成若干段由多个线程用 std::from_chars 并行解析，
+ * 再按原顺序每 3 个点组成一个三角形，结果与逐行 sscanf 解析一致。
+ */
+inline bool ReadMeshData(const std::string& file_path, MeshData& mesh1, MeshData& mesh2, unsigned int num_threads = 1) {
+    ScopedTimer timer("read_mesh_data");
+    MappedFile file(file_path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open input file " << file_path << std::endl;
+        return false;
+    }
+    const char* data = file.data();
+    const std::size_t size = file.size();
+    StatsCount("read_bytes", size);
+
+    // 每段至少 1MB，段边界对齐到下一行的开头
+    constexpr std::size_t min_chunk_size = std::size_t(1) << 20;
+    num_threads = resolve_thread_count(num_threads);
+    const std::size_t num_chunks = num_threads == 1 ? 1 : std::min<std::size_t>(std::size_t(num_threads) * 4, size / min_chunk_size + 1);
+    std::vector<std::size_t> bounds = split_range(size, num_chunks);
+    for (std::size_t c = 1; c + 1 < bounds.size(); ++c) {
+        std::size_t& b = bounds[c];
+        b = std::max(b, bounds[c - 1]);
+        const void* newline = b < size ? std::memchr(data + b, '\n', size - b) : nullptr;
+        b = newline == nullptr ? size : static_cast<std::size_t>(static_cast<const char*>(newline) - data) + 1;
+    }
+
+    std::vector<TextChunk> chunks(bounds.size() - 1);
+    parallel_for(chunks.size(), num_threads, [&](std::size_t c) {
+        parse_text_chunk(data + bounds[c], data + bounds[c + 1], chunks[c]);
+    });
+
+    // 按原顺序组装三角形: 连续 3 个点组成一个三角形，归属第 3 个点读入时所在的网格
+    std::size_t total_points = 0;
+    for (const auto& chunk : chunks) {
+        total_points += chunk.points.size();
+    }
+    mesh1.triangles.reserve(mesh1.triangles.size() + total_points / 3);
+    mesh2.triangles.reserve(mesh2.triangles.size() + total_points / 3);
+
+    Point3D points[3];
+    std::size_t count = 0;
+    bool readingMesh1 = true;
+    for (const auto& chunk : chunks) {
+        std::size_t marker = 0;
+        for (std::size_t i = 0; i <= chunk.points.size(); ++i) {
+            for (; marker < chunk.markers.size() && chunk.markers[marker].first == i; ++marker) {
+                readingMesh1 = chunk.markers[marker].second;
+            }
+            if (i == chunk.points.size()) break;
+            points[count++] = chunk.points[i];
+            if (count == 3) {
+                (readingMesh1 ? mesh1 : mesh2).triangles.emplace_back(points[0], points[1], points[2]);
+                count = 0;
+            }
+        }
+        if (!chunk.ok) {
+            std::cerr << "Error: Invalid format in line: " << chunk.error_line << std::endl;
+            return false;
+        }
+    }
+    StatsCount("read_faces_mesh1", mesh1.triangles.size());
+    StatsCount("read_faces_mesh2", mesh2.triangles.size());
+    return true;
+}
+
+/**
+ * 按块顺序读取文本格式的 mesh1/mesh2，占用的内存只与块大小有关，用于无法整体读入内存的输入。
+ * 三角形的分组规则与 ReadMeshData 相同。
+ */
+class MeshDataStream {
+public:
+    explicit MeshDataStream(const std::string& file_path, std::size_t block_size = std::size_t(64) << 20)
+            : file_(file_path, std::ios::binary)
+            , block_size_(std::max<std::size_t>(block_size, 4096)) {
+        if (!file_.is_open()) {
+            std::cerr << "Error: Unable to open input file " << file_path << std::endl;
+            failed_ = true;
+        }
+    }
+
+    // 读取下一块，把其中的三角形追加到 mesh1/mesh2；没有更多数据或出错时返回 false，出错时 failed() 为 true
+    bool next(MeshData& mesh1, MeshData& mesh2) {
+        if (failed_ || done_) return false;
+
+        // 读入一块，只解析到最后一个完整的行，剩余部分留到下一块
+        std::size_t parse_size = 0;
+        while (parse_size == 0 && !done_) {
+            const std::size_t carried = buffer_.size();
+            buffer_.resize(carried + block_size_);
+            file_.read(buffer_.data() + carried, static_cast<std::streamsize>(block_size_));
+            buffer_.resize(carried + static_cast<std::size_t>(file_.gcount()));
+            StatsCount("read_bytes", static_cast<std::uint64_t>(file_.gcount()));
+            if (!file_) {
+                done_ = true;
+                parse_size = buffer_.size();
+            } else {
+                const std::size_t newline = buffer_.rfind('\n');
+                parse_size = newline == std::string::npos ? 0 : newline + 1;
+            }
+        }
+
+        TextChunk chunk;
+        parse_text_chunk(buffer_.data(), buffer_.data() + parse_size, chunk);
+        buffer_.erase(0, parse_size);
+        if (!chunk.ok) {
+            std::cerr << "Error: Invalid format in line: " << chunk.error_line << std::endl;
+            failed_ = true;
+            return false;
+        }
+
+        std::size_t marker = 0;
+        for (std::size_t i = 0; i <= chunk.points.size(); ++i) {
+            for (; marker < chunk.markers.size() && chunk.markers[marker].first == i; ++marker) {
+                reading_mesh1_ = chunk.markers[marker].second;
+            }
+            if (i == chunk.points.size()) break;
+            points_[count_++] = chunk.points[i];
+            if (count_ == 3) {
+                (reading_mesh1_ ? mesh1 : mesh2).triangles.emplace_back(points_[0], points_[1], points_[2]);
+                count_ = 0;
+            }
+        }
+        return true;
+    }
+
+    bool failed() const { return failed_; }
+
+private:
+    std::ifstream file_;
+    std::size_t block_size_;
+    std::string buffer_;
+    Point3D points_[3];
+    std::size_t count_ = 0;
+    bool reading_mesh1_ = true;
+    bool done_ = false;
+    bool failed_ = false;
+};
+
+// 与 operator<< 的默认格式 (%g, 6 位有效数字) 相同
+inline void append_text_double(std::string& buffer, double value) {
+    char digits[64];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6);
+    buffer.append(digits, result.ptr);
+}
+
+inline void append_text_point(std::string& buffer, const Point3D& point) {
+    append_text_double(buffer, point.x);
+    buffer += ", ";
+    append_text_double(buffer, point.y);
+    buffer += ", ";
+    append_text_double(buffer, point.z);
+    buffer += '\n';
+}
+
+inline void WriteMeshData(const std::string& file_path, const MeshData& mesh1, const MeshData& mesh2, const std::vector<Point3D>& boundary_points) {
+    ScopedTimer timer("write_mesh_data");
+    std::ofstream outfile(file_path);
+    if (!outfile.is_open()) {
+        std::cerr << "Error: Unable to open output file " << file_path << std::endl;
+        return;
+    }
+
+    // 先格式化到缓冲区，写满后整块写出
+    constexpr std::size_t flush_size = std::size_t(4) << 20;
+    std::string buffer;
+    buffer.reserve(flush_size + 256);
+    auto flush_if_full = [&]() {
+        if (buffer.size() >= flush_size) {
+            outfile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    };
+
+    // Write mesh1
+    buffer += "mesh1:\n";
+    for (const auto& triangle : mesh1.triangles) {
+        for (const auto& point : triangle.points) {
+            append_text_point(buffer, point);
+        }
+        flush_if_full();
+    }
+
+    // Write mesh2
+    buffer += "mesh2:\n";
+    for (const auto& triangle : mesh2.triangles) {
+        for (const auto& point : triangle.points) {
+            append_text_point(buffer, point);
+        }
+        flush_if_full();
+    }
+
+    // Write boundary points
+    buffer += "boundary_points:\n";
+    for (const auto& point : boundary_points) {
+        append_text_point(buffer, point);
+        flush_if_full();
+    }
+
+    outfile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    outfile.close();
+}
+
+#endif //MESH_INTERSECTION_MESH_DATA_H
@@ -6,100 +6,259 @@
 #define MESH_INTERSECTION_MESH_INTERSECTION_H
 
 
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
-#include <CGAL/Surface_mesh.h>
 #include <CGAL/Polygon_mesh_processing/corefinement.h>
 #include <CGAL/Polygon_mesh_processing/IO/polygon_mesh_io.h>
+#include <CGAL/version.h>
+#include <array>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
-typedef CGAL::Exact_predicates_inexact_constructions_kernel K;
-typedef CGAL::Exact_predicates_exact_constructions_kernel EK;
-typedef CGAL::Surface_mesh<K::Point_3> Mesh;
-typedef boost::graph_traits<Mesh>::vertex_descriptor vertex_descriptor;
-typedef Mesh::Property_map<vertex_descriptor,EK::Point_3> Exact_point_map;
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#if CGAL_VERSION_MAJOR < 6
+#include <boost/optional.hpp>
+#endif
+#include "examples/kernels.h"
+#include "examples/stats.h"
 namespace PMP = CGAL::Polygon_mesh_processing;
 namespace params = CGAL::parameters;
+/**
+ * 按需保存精确坐标的顶点坐标映射。
+ * 只有被 put 写入 (共精细化新建或移动) 的顶点才保存 EK::Point_3，其余顶点在 get 时由输入坐标转换，不保存转换结果，
+ * 因此构造时不遍历顶点，内存随新建顶点数而不是网格大小增长。
+ * 精确坐标由所有副本共享，最后一个副本析构时释放。Kernel 为网格本身的内核。
+ */
+template <class Kernel = K>
 struct Exact_vertex_point_map
 {
     // typedef for the property map
-    typedef boost::property_traits<Exact_point_map>::value_type value_type;
-    typedef boost::property_traits<Exact_point_map>::reference reference;
-    typedef boost::property_traits<Exact_point_map>::key_type key_type;
+    typedef EK::Point_3 value_type;
+    typedef EK::Point_3 reference;
+    typedef typename boost::graph_traits<Kernel_mesh<Kernel>>::vertex_descriptor key_type;
     typedef boost::read_write_property_map_tag category;
     // exterior references
-    Exact_point_map exact_point_map;
-    Mesh* tm_ptr;
+    std::shared_ptr<std::unordered_map<std::uint32_t, EK::Point_3>> exact_points;
+    Kernel_mesh<Kernel>* tm_ptr;
     // Converters
-    CGAL::Cartesian_converter<K, EK> to_exact;
-    CGAL::Cartesian_converter<EK, K> to_input;
+    CGAL::Cartesian_converter<Kernel, EK> to_exact;
+    CGAL::Cartesian_converter<EK, Kernel> to_input;
     Exact_vertex_point_map()
             : tm_ptr(nullptr)
     {}
-    Exact_vertex_point_map(const Exact_point_map& ep, Mesh& tm)
-            : exact_point_map(ep)
+    explicit Exact_vertex_point_map(Kernel_mesh<Kernel>& tm)
+            : exact_points(std::make_shared<std::unordered_map<std::uint32_t, EK::Point_3>>())
             , tm_ptr(&tm)
-    {
-        for (Mesh::Vertex_index v : vertices(tm))
-            exact_point_map[v]=to_exact(tm.point(v));
-    }
+    {}
     friend
     reference get(const Exact_vertex_point_map& map, key_type k)
     {
         CGAL_precondition(map.tm_ptr!=nullptr);
-        return map.exact_point_map[k];
+        const auto it = map.exact_points->find(k.idx());
+        return it != map.exact_points->end() ? it->second : map.to_exact(map.tm_ptr->point(k));
     }
     friend
     void put(const Exact_vertex_point_map& map, key_type k, const EK::Point_3& p)
     {
         CGAL_precondition(map.tm_ptr!=nullptr);
-        map.exact_point_map[k]=p;
+        (*map.exact_points)[k.idx()]=p;
         // create the input point from the exact one
         map.tm_ptr->point(k)=map.to_input(p);
     }
 };
 
-bool mesh_intersection(const std::string& file1, const std::string& file2)
+// 布尔运算结果的可选输出，CGAL 6 起使用 std::optional
+#if CGAL_VERSION_MAJOR >= 6
+template <class Kernel>
+using Kernel_boolean_output = std::optional<Kernel_mesh<Kernel>*>;
+#else
+template <class Kernel>
+using Kernel_boolean_output = boost::optional<Kernel_mesh<Kernel>*>;
+#endif
+typedef Kernel_boolean_output<K> Boolean_output;
+
+/**
+ * 需要计算的布尔运算结果: 非空指针表示需要该结果，结果写入指向的网格，不能指向输入网格。
+ */
+template <class Kernel>
+struct Kernel_boolean_outputs
 {
-    const std::string filename1 = (file1.size() > 0) ? file1 : CGAL::data_file_path(R"(D:\Code\Data\Sphere_10.ply)");
-    const std::string filename2 = (file2.size() > 0) ? file2 : CGAL::data_file_path(R"(D:\Code\Data\Plane.ply)");
-    Mesh mesh1, mesh2;
+    Kernel_mesh<Kernel>* union_mesh = nullptr;
+    Kernel_mesh<Kernel>* intersection = nullptr;
+    Kernel_mesh<Kernel>* mesh1_minus_mesh2 = nullptr;
+    Kernel_mesh<Kernel>* mesh2_minus_mesh1 = nullptr;
+};
+typedef Kernel_boolean_outputs<K> Boolean_outputs;
 
-    if(!PMP::IO::read_polygon_mesh(filename1, mesh1) || !PMP::IO::read_polygon_mesh(filename2, mesh2))
+/**
+ * 只做一次共精细化，同时得到所有需要的布尔运算结果。mesh1 与 mesh2 被共精细化，但不被结果覆盖。
+ * 返回值按 PMP::Corefinement::Boolean_operation_type 的顺序 (并集、交集、mesh1 - mesh2、mesh2 - mesh1)
+ * 表示各结果是否计算成功，未请求的结果为 false。
+ * Epeck 网格的构造本身是精确的，直接在网格坐标上计算；其余内核借助 Exact_vertex_point_map 保存精确的新顶点。
+ */
+template <class Kernel>
+std::array<bool, 4> boolean_operations(Kernel_mesh<Kernel>& mesh1, Kernel_mesh<Kernel>& mesh2,
+                                       const std::type_identity_t<Kernel_boolean_outputs<Kernel>>& outputs)
+{
+    static_assert(kernel_has_exact_predicates<Kernel>, "boolean operations require a kernel with exact predicates");
+    ScopedTimer timer("boolean_operations");
+    StatsCount("input_faces_mesh1", mesh1.number_of_faces());
+    StatsCount("input_faces_mesh2", mesh2.number_of_faces());
+
+    Kernel_mesh<Kernel>* const meshes[4] = {outputs.union_mesh, outputs.intersection, outputs.mesh1_minus_mesh2, outputs.mesh2_minus_mesh1};
+    std::array<Kernel_boolean_output<Kernel>, 4> requested;
+    for (std::size_t i = 0; i < 4; ++i)
     {
-        std::cerr << "Invalid input." << std::endl;
-        return false;
+        if (meshes[i] != nullptr) requested[i] = meshes[i];
+    }
+
+    std::array<bool, 4> computed{};
+    if constexpr (std::is_same_v<Kernel, EK>)
+    {
+        computed = PMP::corefine_and_compute_boolean_operations(mesh1, mesh2, requested);
+    }
+    else
+    {
+        Exact_vertex_point_map<Kernel> mesh1_vpm(mesh1);
+        Exact_vertex_point_map<Kernel> mesh2_vpm(mesh2);
+        std::array<Exact_vertex_point_map<Kernel>, 4> output_vpm;
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            if (meshes[i] != nullptr) output_vpm[i] = Exact_vertex_point_map<Kernel>(*meshes[i]);
+        }
+
+        computed = PMP::corefine_and_compute_boolean_operations(mesh1,
+                                                                mesh2,
+                                                                requested,
+                                                                params::vertex_point_map(mesh1_vpm),
+                                                                params::vertex_point_map(mesh2_vpm),
+                                                                std::make_tuple(params::vertex_point_map(output_vpm[0]),
+                                                                                params::vertex_point_map(output_vpm[1]),
+                                                                                params::vertex_point_map(output_vpm[2]),
+                                                                                params::vertex_point_map(output_vpm[3])));
+        std::size_t exact_points = mesh1_vpm.exact_points->size() + mesh2_vpm.exact_points->size();
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            if (meshes[i] != nullptr) exact_points += output_vpm[i].exact_points->size();
+        }
+        StatsCount("exact_points", exact_points);
+    }
+
+    std::array<bool, 4> result{};
+    for (std::size_t i = 0; i < 4; ++i)
+        result[i] = meshes[i] != nullptr && computed[i];
+    return result;
+}
+
+/**
+ * 一次共精细化计算所有需要的布尔运算结果并写入文件。
+ * output_files 按并集、交集、mesh1 - mesh2、mesh2 - mesh1 的顺序给出，空字符串表示不需要该结果。
+ */
+template <class Kernel>
+bool boolean_operations(Kernel_mesh<Kernel>& mesh1, Kernel_mesh<Kernel>& mesh2, const std::array<std::string, 4>& output_files)
+{
+    static const char* const names[4] = {"Union", "Intersection", "Difference mesh1 - mesh2", "Difference mesh2 - mesh1"};
+    static const char* const face_counters[4] = {"faces_union", "faces_intersection", "faces_mesh1_minus_mesh2", "faces_mesh2_minus_mesh1"};
+    std::array<Kernel_mesh<Kernel>, 4> results;
+    Kernel_boolean_outputs<Kernel> outputs;
+    Kernel_mesh<Kernel>** const requested[4] = {&outputs.union_mesh, &outputs.intersection, &outputs.mesh1_minus_mesh2, &outputs.mesh2_minus_mesh1};
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        if (!output_files[i].empty()) *requested[i] = &results[i];
+    }
+
+    const std::array<bool, 4> computed = boolean_operations<Kernel>(mesh1, mesh2, outputs);
+    ScopedTimer timer("write_output");
+    bool success = true;
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        if (output_files[i].empty()) continue;
+        if (!computed[i])
+        {
+            std::cout << names[i] << " could not be computed\n";
+            success = false;
+            continue;
+        }
+        StatsCount(face_counters[i], results[i].number_of_faces());
+        CGAL::IO::write_polygon_mesh(output_files[i], results[i], CGAL::parameters::stream_precision(17));
     }
-    Exact_point_map mesh1_exact_points =
-            mesh1.add_property_map<vertex_descriptor,EK::Point_3>("v:exact_point").first;
-    Exact_point_map mesh2_exact_points =
-            mesh2.add_property_map<vertex_descriptor,EK::Point_3>("v:exact_point").first;
-    Exact_vertex_point_map mesh1_vpm(mesh1_exact_points, mesh1);
-    Exact_vertex_point_map mesh2_vpm(mesh2_exact_points, mesh2);
-    if ( PMP::corefine_and_compute_intersection(mesh1,
-                                                mesh2,
-                                                mesh1,
-                                                params::vertex_point_map(mesh1_vpm),
-                                                params::vertex_point_map(mesh2_vpm),
-                                                params::vertex_point_map(mesh1_vpm) ) )
+    return success;
+}
+
+/**
+ * boolean 命令与批处理 boolean 作业共用的选项: 各结果的输出文件 (顺序同 boolean_operations 的 output_files，
+ * 空字符串表示不需要) 与所用内核。
+ */
+struct BooleanOptions
+{
+    std::array<std::string, 4> output_files;
+    MeshKernel kernel = MeshKernel::Epick;
+};
+
+// 解析 --union=FILE、--intersection=FILE、--mesh1-minus-mesh2=FILE、--mesh2-minus-mesh1=FILE 与 --kernel=NAME，
+// 不是 boolean 选项时返回 false；内核不支持布尔运算时抛出 std::invalid_argument
+inline bool ParseBooleanOption(const std::string& arg, BooleanOptions& options)
+{
+    static const char* const output_options[4] = {"--union=", "--intersection=", "--mesh1-minus-mesh2=", "--mesh2-minus-mesh1="};
+    for (std::size_t i = 0; i < 4; ++i)
     {
-        CGAL::IO::write_polygon_mesh("inter_intersection.off", mesh1, CGAL::parameters::stream_precision(17));
-        if ( PMP::corefine_and_compute_union(mesh1,
-                                             mesh2,
-                                             mesh2,
-                                             params::vertex_point_map(mesh1_vpm),
-                                             params::vertex_point_map(mesh2_vpm),
-                                             params::vertex_point_map(mesh2_vpm) ) )
+        const std::string option = output_options[i];
+        if (arg.rfind(option, 0) == 0)
         {
-            std::cout << "Intersection and union were successfully computed\n";
-            CGAL::IO::write_polygon_mesh("inter_union.off", mesh2, CGAL::parameters::stream_precision(17));
+            options.output_files[i] = arg.substr(option.size());
             return true;
         }
-        std::cout << "Union could not be computed\n";
-        return false;
     }
-    std::cout << "Intersection could not be computed\n";
+    if (arg.rfind("--kernel=", 0) == 0)
+    {
+        if (!ParseMeshKernel(arg.substr(9), options.kernel) || !IsCorefinementKernel(options.kernel))
+            throw std::invalid_argument("unsupported kernel " + arg.substr(9) + " (expected epick or epeck)");
+        return true;
+    }
+    return false;
+}
+
+inline bool HasBooleanOutput(const BooleanOptions& options)
+{
+    for (const auto& file : options.output_files)
+    {
+        if (!file.empty()) return true;
+    }
     return false;
 }
 
+/**
+ * 计算 mesh1 与 mesh2 的交集和并集，分别写入 output_intersection 与 output_union。
+ * 两个结果来自同一次共精细化，mesh1 与 mesh2 只被共精细化，不被结果覆盖。
+ */
+template <class Kernel>
+bool mesh_intersection(Kernel_mesh<Kernel>& mesh1, Kernel_mesh<Kernel>& mesh2, const std::string& output_intersection, const std::string& output_union)
+{
+    if (!boolean_operations(mesh1, mesh2, std::array<std::string, 4>{output_union, output_intersection, "", ""}))
+        return false;
+    std::cout << "Intersection and union were successfully computed\n";
+    return true;
+}
+
+inline bool mesh_intersection(const std::string& file1, const std::string& file2)
+{
+    const std::string filename1 = (file1.size() > 0) ? file1 : CGAL::data_file_path(R"(D:\Code\Data\Sphere_10.ply)");
+    const std::string filename2 = (file2.size() > 0) ? file2 : CGAL::data_file_path(R"(D:\Code\Data\Plane.ply)");
+    Mesh mesh1, mesh2;
+
+    if(!PMP::IO::read_polygon_mesh(filename1, mesh1) || !PMP::IO::read_polygon_mesh(filename2, mesh2))
+    {
+        std::cerr << "Invalid input." << std::endl;
+        return false;
+    }
+    return mesh_intersection(mesh1, mesh2, "inter_intersection.off", "inter_union.off");
+}
+
+// Epick 与 Epeck 的布尔运算在 kernel_instantiations.cpp 中显式实例化
+extern template std::array<bool, 4> boolean_operations<K>(Kernel_mesh<K>&, Kernel_mesh<K>&, const Kernel_boolean_outputs<K>&);
+extern template std::array<bool, 4> boolean_operations<EK>(Kernel_mesh<EK>&, Kernel_mesh<EK>&, const Kernel_boolean_outputs<EK>&);
+
 #endif //MESH_INTERSECTION_MESH_INTERSECTION_H
@@ -0,0 +1,375 @@
+//
+// Created by RainSure on 24-10-22.
+//
+
+#ifndef MESH_INTERSECTION_MULTI_CLIP_H
+#define MESH_INTERSECTION_MULTI_CLIP_H
+
+#include <CGAL/Polygon_mesh_processing/bbox.h>
+#include <CGAL/Polygon_mesh_processing/connected_components.h>
+#include <CGAL/box_intersection_d.h>
+#include <CGAL/Box_intersection_d/Box_with_info_d.h>
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+#include "examples/co_refinement.h"
+#include "examples/kernels.h"
+#include "examples/parallel.h"
+#include "examples/stats.h"
+
+/**
+ * 一次裁剪掉多个裁剪体: 删除 mesh2 中位于任意一个裁剪体内部的面。
+ *
+ * 1. 所有裁剪体的面包围盒放入同一个索引，与 mesh2 的面包围盒做一次 box_intersection_d，
+ *    得到每个裁剪体交叠的 mesh2 面；交叠到同一个 mesh2 面的裁剪体归为一组；
+ * 2. 每组交叠的 mesh2 面取出为一块面片，组内的裁剪体依次与该面片共精细化，
+ *    各组的面片互不相交，可以并行处理；不交叠 mesh2 的裁剪体不做共精细化；
+ * 3. 面片拼回 mesh2 后，按所有裁剪体的交线把 mesh2 分成连通面片，每个面片的代表点只与包围盒包含它的裁剪体做点定位，
+ *    在任意一个裁剪体内部或边界上的面片一次删除。
+ *
+ * 因此 mesh2 只遍历常数次，共精细化的代价随交叠的裁剪体及其交叠区域增长，而不是随裁剪体数乘以 mesh2 的大小增长。
+ * 与依次调用 ClipMesh 相同，两个裁剪体的交线在 mesh2 上相交的点只计入后处理的裁剪体的交线点。
+ * 分类总是按面片进行 (ClipOptions::vertex_classification 与 local_corefine 不起作用)。
+ */
+
+typedef CGAL::Box_intersection_d::Box_with_info_d<double, 3, std::size_t> Indexed_box;
+
+// 交叠同一块 mesh2 区域的一组裁剪体
+struct CutterGroup {
+    std::vector<std::size_t> cutters;
+    // 与组内裁剪体的面包围盒交叠的 mesh2 面，排序
+    std::vector<Face_index> faces;
+};
+
+/**
+ * 用所有裁剪体的面包围盒索引找出每个裁剪体交叠的 mesh2 面，并把交叠到同一个面的裁剪体并为一组。
+ * 返回的组按其中最小的裁剪体编号排序。
+ */
+template <class Kernel>
+std::vector<CutterGroup> group_overlapping_cutters(const std::vector<Kernel_mesh<Kernel>>& cutters, const Kernel_mesh<Kernel>& mesh2) {
+    ScopedTimer timer("cutter_index");
+    std::vector<Indexed_box> cutter_boxes;
+    CGAL::Bbox_3 cutters_bbox;
+    for (std::size_t c = 0; c < cutters.size(); ++c) {
+        for (Face_index f : cutters[c].faces()) {
+            const CGAL::Bbox_3 box = PMP::face_bbox(f, cutters[c]);
+            cutter_boxes.emplace_back(box, c);
+            cutters_bbox += box;
+        }
+    }
+    std::vector<Indexed_box> boxes2;
+    for (Face_index f : mesh2.faces()) {
+        const CGAL::Bbox_3 box = PMP::face_bbox(f, mesh2);
+        if (CGAL::do_overlap(box, cutters_bbox)) boxes2.emplace_back(box, f.idx());
+    }
+
+    // (mesh2 面, 裁剪体) 对
+    std::vector<std::pair<std::size_t, std::size_t>> touches;
+    CGAL::box_intersection_d(boxes2.begin(), boxes2.end(), cutter_boxes.begin(), cutter_boxes.end(),
+                             [&touches](const Indexed_box& b2, const Indexed_box& b1) {
+                                 touches.emplace_back(b2.info(), b1.info());
+                             });
+    std::sort(touches.begin(), touches.end());
+    touches.erase(std::unique(touches.begin(), touches.end()), touches.end());
+
+    // 并查集: 交叠同一个 mesh2 面的裁剪体合并
+    std::vector<std::size_t> parent(cutters.size());
+    std::iota(parent.begin(), parent.end(), std::size_t(0));
+    auto find = [&parent](std::size_t c) {
+        while (parent[c] != c) {
+            parent[c] = parent[parent[c]];
+            c = parent[c];
+        }
+        return c;
+    };
+    for (std::size_t i = 1; i < touches.size(); ++i) {
+        if (touches[i].first == touches[i - 1].first) {
+            const std::size_t a = find(touches[i - 1].second), b = find(touches[i].second);
+            if (a != b) parent[std::max(a, b)] = std::min(a, b);
+        }
+    }
+
+    std::vector<std::size_t> group_of(cutters.size(), cutters.size());
+    std::vector<char> overlaps(cutters.size(), 0);
+    for (const auto& touch : touches) {
+        overlaps[touch.second] = 1;
+    }
+    std::vector<CutterGroup> groups;
+    for (std::size_t c = 0; c < cutters.size(); ++c) {
+        if (!overlaps[c]) continue;
+        const std::size_t root = find(c);
+        if (group_of[root] == cutters.size()) {
+            group_of[root] = groups.size();
+            groups.emplace_back();
+        }
+        groups[group_of[root]].cutters.push_back(c);
+    }
+    // touches 按面排序，每个面只加入一次
+    for (std::size_t i = 0; i < touches.size(); ++i) {
+        if (i > 0 && touches[i].first == touches[i - 1].first) continue;
+        groups[group_of[find(touches[i].second)]].faces.push_back(Face_index(static_cast<std::uint32_t>(touches[i].first)));
+    }
+
+    std::size_t overlapping = 0;
+    for (const auto& group : groups) {
+        overlapping += group.cutters.size();
+    }
+    StatsCount("overlapping_cutters", overlapping);
+    StatsCount("cutter_groups", groups.size());
+    return groups;
+}
+
+/**
+ * 组内的裁剪体依次与面片共精细化，每个裁剪体的交线点写入 boundary_points[c]。
+ * 返回面片上的 "e:constrained": 两端都在某条交线上的边为 true。
+ * 后处理的裁剪体可能把先处理的裁剪体的交线边切开，新边不在任何一次共精细化的约束边中，
+ * 因此按顶点记录交线 (约束边的端点与共精细化新建的顶点)；两端都在交线上但不属于交线的边只会把面片分得更细，不影响分类结果。
+ */
+template <class Kernel>
+Kernel_edge_constrained_map<Kernel> corefine_cutter_group(std::vector<Kernel_mesh<Kernel>>& cutters, const CutterGroup& group, LocalPatch<Kernel>& patch,
+                                                          std::vector<std::vector<CGAL::Point_3<Kernel>>>& boundary_points) {
+    auto& mesh = patch.mesh;
+    auto on_curve = mesh.template add_property_map<Vertex_index, bool>("v:on_curve", false).first;
+    for (std::size_t c : group.cutters) {
+        auto cut = mesh.template add_property_map<Edge_index, bool>("e:cut", false).first;
+        const std::size_t first_new_vertex = mesh.num_vertices();
+        PMP::corefine(cutters[c], mesh, CGAL::parameters::default_values(), CGAL::parameters::edge_is_constrained_map(cut));
+        boundary_polylines(mesh, cut, boundary_points[c]);
+        for (Edge_index e : mesh.edges()) {
+            if (cut[e]) {
+                on_curve[mesh.source(mesh.halfedge(e))] = true;
+                on_curve[mesh.target(mesh.halfedge(e))] = true;
+            }
+        }
+        for (Vertex_index v : mesh.vertices()) {
+            if (v.idx() >= first_new_vertex) on_curve[v] = true;
+        }
+        mesh.remove_property_map(cut);
+    }
+
+    auto constrained = mesh.template add_property_map<Edge_index, bool>("e:constrained", false).first;
+    for (Edge_index e : mesh.edges()) {
+        constrained[e] = on_curve[mesh.source(mesh.halfedge(e))] && on_curve[mesh.target(mesh.halfedge(e))];
+    }
+    mesh.remove_property_map(on_curve);
+    return constrained;
+}
+
+/**
+ * 按 constrained 把 mesh2 分成连通面片，返回面属性 "f:inside": 所在面片位于任意一个裁剪体内部或边界上的面为 1。
+ * 各面片代表点的包围盒与裁剪体的整体包围盒做一次 box_intersection_d，只对包含代表点的裁剪体做点定位，
+ * 只有被查询到的裁剪体才建 AABB 树。
+ */
+template <class Kernel>
+Kernel_face_label_map<Kernel> classify_patches_multi(Kernel_mesh<Kernel>& mesh2, const std::vector<Kernel_mesh<Kernel>>& cutters,
+                                                     const Kernel_edge_constrained_map<Kernel>& constrained, unsigned int num_threads = 1) {
+    typedef Kernel_mesh<Kernel> Mesh;
+    ScopedTimer timer("classification");
+    auto label = mesh2.template add_property_map<Face_index, std::size_t>("f:inside", 0).first;
+    const std::size_t num_patches = PMP::connected_components(mesh2, label, CGAL::parameters::edge_is_constrained_map(constrained));
+
+    std::vector<Face_index> representative(num_patches, Mesh::null_face());
+    for (Face_index f : mesh2.faces()) {
+        if (representative[label[f]] == Mesh::null_face()) representative[label[f]] = f;
+    }
+    std::vector<CGAL::Point_3<Kernel>> points;
+    std::vector<Indexed_box> point_boxes;
+    points.reserve(num_patches);
+    point_boxes.reserve(num_patches);
+    for (std::size_t i = 0; i < num_patches; ++i) {
+        const auto h = mesh2.halfedge(representative[i]);
+        points.push_back(CGAL::centroid(mesh2.point(mesh2.target(h)),
+                                        mesh2.point(mesh2.target(mesh2.next(h))),
+                                        mesh2.point(mesh2.target(mesh2.next(mesh2.next(h))))));
+        point_boxes.emplace_back(points.back().bbox(), i);
+    }
+    std::vector<Indexed_box> cutter_boxes;
+    for (std::size_t c = 0; c < cutters.size(); ++c) {
+        if (!cutters[c].is_empty()) cutter_boxes.emplace_back(PMP::bbox(cutters[c]), c);
+    }
+
+    // (面片, 裁剪体) 候选对，按面片排序后压缩为每个面片的候选区间
+    std::vector<std::pair<std::size_t, std::size_t>> candidates;
+    CGAL::box_intersection_d(point_boxes.begin(), point_boxes.end(), cutter_boxes.begin(), cutter_boxes.end(),
+                             [&candidates](const Indexed_box& point_box, const Indexed_box& cutter_box) {
+                                 candidates.emplace_back(point_box.info(), cutter_box.info());
+                             });
+    std::sort(candidates.begin(), candidates.end());
+    std::vector<std::size_t> first_candidate(num_patches + 1, 0);
+    for (const auto& candidate : candidates) {
+        ++first_candidate[candidate.first + 1];
+    }
+    for (std::size_t i = 0; i < num_patches; ++i) {
+        first_candidate[i + 1] += first_candidate[i];
+    }
+
+    num_threads = kernel_thread_count<Kernel>(num_threads);
+    std::vector<std::size_t> queried;
+    for (const auto& candidate : candidates) {
+        queried.push_back(candidate.second);
+    }
+    std::sort(queried.begin(), queried.end());
+    queried.erase(std::unique(queried.begin(), queried.end()), queried.end());
+    std::vector<std::unique_ptr<Kernel_face_tree<Kernel>>> trees(cutters.size());
+    {
+        ScopedTimer tree_timer("build_tree");
+        parallel_for(queried.size(), num_threads, [&](std::size_t i) {
+            const Mesh& cutter = cutters[queried[i]];
+            auto tree = std::make_unique<Kernel_face_tree<Kernel>>(faces(cutter).first, faces(cutter).second, cutter);
+            tree->build();
+            trees[queried[i]] = std::move(tree);
+        });
+    }
+
+    std::vector<char> inside_patch(num_patches, 0);
+    const std::vector<std::size_t> bounds = split_range(num_patches, num_threads == 1 ? 1 : std::size_t(num_threads) * 8);
+    parallel_for(bounds.size() - 1, num_threads, [&](std::size_t c) {
+        for (std::size_t i = bounds[c]; i < bounds[c + 1]; ++i) {
+            // 在任意一个裁剪体内部即可，找到后不再查询其余裁剪体
+            for (std::size_t k = first_candidate[i]; k < first_candidate[i + 1] && !inside_patch[i]; ++k) {
+                Kernel_point_inside<Kernel> inside(*trees[candidates[k].second]);
+                const CGAL::Bounded_side side = inside(points[i]);
+                inside_patch[i] = side == CGAL::ON_BOUNDED_SIDE || side == CGAL::ON_BOUNDARY;
+            }
+        }
+    });
+
+    for (Face_index f : mesh2.faces()) {
+        label[f] = inside_patch[label[f]];
+    }
+    StatsCount("patches", num_patches);
+    StatsCount("point_location_queries", candidates.size());
+    return label;
+}
+
+/**
+ * 只保留仍是 mesh 中某个面的顶点的交线点: 一个裁剪体的交线落在另一个裁剪体内部的部分随面一起被删除。
+ * 保持各列表中点的顺序。
+ */
+template <class Kernel>
+void keep_points_on_mesh(const Kernel_mesh<Kernel>& mesh, std::vector<std::vector<CGAL::Point_3<Kernel>>>& boundary_points) {
+    auto less = [](const CGAL::Point_3<Kernel>& a, const CGAL::Point_3<Kernel>& b) {
+        return CGAL::compare_xyz(a, b) == CGAL::SMALLER;
+    };
+    std::vector<CGAL::Point_3<Kernel>> kept;
+    kept.reserve(mesh.number_of_vertices());
+    for (Vertex_index v : mesh.vertices()) {
+        if (!mesh.is_isolated(v)) kept.push_back(mesh.point(v));
+    }
+    std::sort(kept.begin(), kept.end(), less);
+
+    std::size_t dropped = 0;
+    for (auto& points : boundary_points) {
+        const auto end = std::remove_if(points.begin(), points.end(), [&](const CGAL::Point_3<Kernel>& p) {
+            return !std::binary_search(kept.begin(), kept.end(), p, less);
+        });
+        dropped += static_cast<std::size_t>(points.end() - end);
+        points.erase(end, points.end());
+    }
+    StatsCount("boundary_points_removed", dropped);
+}
+
+/**
+ * 用多个封闭的裁剪体一次裁剪 mesh2 (见文件开头的说明)。cutters 被就地共精细化，mesh2 替换为裁剪后的网格，
+ * boundary_points[c] 为第 c 个裁剪体在裁剪后的 mesh2 上的交线点 (按折线顺序，每个点一次)，
+ * 落在其他裁剪体内部、已被删除的部分不计入。
+ * 有裁剪体不是封闭的三角网格时返回 false，此时不修改任何网格。
+ */
+template <class Kernel>
+bool clip_with_cutters(std::vector<Kernel_mesh<Kernel>>& cutters, Kernel_mesh<Kernel>& mesh2,
+                       std::vector<std::vector<CGAL::Point_3<Kernel>>>& boundary_points,
+                       const ClipOptions& options = ClipOptions(), std::size_t* removed_faces = nullptr) {
+    static_assert(kernel_has_exact_predicates<Kernel>, "corefinement requires a kernel with exact predicates");
+    for (std::size_t c = 0; c < cutters.size(); ++c) {
+        if (!CGAL::is_triangle_mesh(cutters[c]) || !CGAL::is_closed(cutters[c])) {
+            std::cerr << "Error: Cutter " << c << " is not a closed triangle mesh." << std::endl;
+            return false;
+        }
+    }
+    StatsCount("cutters", cutters.size());
+    boundary_points.assign(cutters.size(), {});
+
+    std::vector<CutterGroup> groups = group_overlapping_cutters(cutters, mesh2);
+    std::vector<LocalPatch<Kernel>> patches(groups.size());
+    std::vector<Kernel_edge_constrained_map<Kernel>> patch_constrained(groups.size());
+    auto constrained = mesh2.template add_property_map<Edge_index, bool>("e:constrained", false).first;
+    {
+        ScopedTimer timer("corefine");
+        for (std::size_t g = 0; g < groups.size(); ++g) {
+            extract_patch(mesh2, groups[g].faces, patches[g]);
+            StatsCount("local_patch_faces_mesh2", groups[g].faces.size());
+        }
+        // 各组的裁剪体与面片互不相同，组之间并行
+        parallel_for(groups.size(), kernel_thread_count<Kernel>(options.num_threads), [&](std::size_t g) {
+            patch_constrained[g] = corefine_cutter_group(cutters, groups[g], patches[g], boundary_points);
+        });
+
+        for (std::size_t g = 0; g < groups.size(); ++g) {
+            stitch_patch(mesh2, groups[g].faces, patches[g], &patch_constrained[g], &constrained);
+            // 拼回后立即释放面片
+            patches[g] = LocalPatch<Kernel>();
+        }
+        mesh2.collect_garbage();
+    }
+    StatsCount("faces_after_corefine_mesh2", mesh2.number_of_faces());
+
+    auto label = classify_patches_multi(mesh2, cutters, constrained, options.num_threads);
+    mesh2.remove_property_map(constrained);
+    const std::size_t removed = remove_labeled_faces(mesh2, label);
+    if (removed_faces != nullptr) *removed_faces = removed;
+    keep_points_on_mesh(mesh2, boundary_points);
+    return true;
+}
+
+/**
+ * 以 Kernel 构造网格并用多个裁剪体裁剪 mesh2: 每个裁剪体替换为共精细化后的网格，mesh2 替换为裁剪后的网格，
+ * boundary_points[c] 为第 c 个裁剪体的交线点。有裁剪体不是封闭的三角网格时返回 false。
+ */
+template <class Kernel>
+bool ClipMeshMulti(std::vector<std::vector<Triangle3D>>& cutters, std::vector<Triangle3D>& mesh2,
+                   std::vector<std::vector<Point3D>>& boundary_points, const ClipOptions& options) {
+    ScopedTimer timer("clip_mesh_multi");
+    StatsCount("input_faces_mesh2", mesh2.size());
+
+    std::vector<Kernel_mesh<Kernel>> cgal_cutters(cutters.size());
+    for (std::size_t c = 0; c < cutters.size(); ++c) {
+        StatsCount("input_faces_mesh1", cutters[c].size());
+        BuildMesh(cutters[c], cgal_cutters[c], options);
+    }
+    Kernel_mesh<Kernel> cgal_mesh2;
+    BuildMesh(mesh2, cgal_mesh2, options);
+
+    std::vector<std::vector<CGAL::Point_3<Kernel>>> points;
+    if (!clip_with_cutters(cgal_cutters, cgal_mesh2, points, options)) {
+        return false;
+    }
+
+    boundary_points.assign(points.size(), {});
+    for (std::size_t c = 0; c < points.size(); ++c) {
+        boundary_points[c].reserve(points[c].size());
+        for (const auto& point : points[c]) {
+            boundary_points[c].push_back(to_point3d(point));
+        }
+        MeshToTriangles(cgal_cutters[c], cutters[c]);
+    }
+    MeshToTriangles(cgal_mesh2, mesh2);
+    return true;
+}
+
+// 按 options.kernel 选择内核 (Float 改用 Epick，见 dispatch_exact_kernel)
+inline bool ClipMeshMulti(std::vector<std::vector<Triangle3D>>& cutters, std::vector<Triangle3D>& mesh2,
+                          std::vector<std::vector<Point3D>>& boundary_points, const ClipOptions& options = ClipOptions()) {
+    return dispatch_exact_kernel(options.kernel, [&](auto kernel) {
+        return ClipMeshMulti<decltype(kernel)>(cutters, mesh2, boundary_points, options);
+    });
+}
+
+// Epick 与 Epeck 的多裁剪体流程在 kernel_instantiations.cpp 中显式实例化
+extern template bool ClipMeshMulti<K>(std::vector<std::vector<Triangle3D>>&, std::vector<Triangle3D>&, std::vector<std::vector<Point3D>>&, const ClipOptions&);
+extern template bool ClipMeshMulti<EK>(std::vector<std::vector<Triangle3D>>&, std::vector<Triangle3D>&, std::vector<std::vector<Point3D>>&, const ClipOptions&);
+
+#endif //MESH_INTERSECTION_MULTI_CLIP_H
@@ -0,0 +1,80 @@
+//
+// Created by RainSure on 24-9-20.
+//
+
+#ifndef MESH_INTERSECTION_PARALLEL_H
+#define MESH_INTERSECTION_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * 线程数为 0 时取硬件线程数
+ */
+inline unsigned int resolve_thread_count(unsigned int num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return num_threads;
+}
+
+/**
+ * 对 [0, count) 中的每个下标调用 fn(i)，下标由各线程动态领取。
+ * fn 抛出的第一个异常会在所有线程结束后重新抛出。
+ */
+template <class Function>
+void parallel_for(std::size_t count, unsigned int num_threads, Function&& fn) {
+    num_threads = static_cast<unsigned int>(std::min<std::size_t>(resolve_thread_count(num_threads), count));
+    if (num_threads <= 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto worker = [&]() {
+        try {
+            for (std::size_t i = next++; i < count; i = next++) {
+                fn(i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+            next = count;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (unsigned int t = 1; t < num_threads; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+/**
+ * 把 [0, count) 切成大约 num_chunks 段连续区间，返回各段起点，末尾附加 count
+ */
+inline std::vector<std::size_t> split_range(std::size_t count, std::size_t num_chunks) {
+    num_chunks = std::max<std::size_t>(1, std::min(num_chunks, count));
+    std::vector<std::size_t> bounds;
+    bounds.reserve(num_chunks + 1);
+    for (std::size_t c = 0; c <= num_chunks; ++c) {
+        bounds.push_back(count * c / num_chunks);
+    }
+    return bounds;
+}
+
+#endif //MESH_INTERSECTION_PARALLEL_H
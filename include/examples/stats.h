@@ -0,0 +1,227 @@
+//
+// Created by RainSure on 24-10-16.
+//
+
+#ifndef MESH_INTERSECTION_STATS_H
+#define MESH_INTERSECTION_STATS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+// 进程已使用的 CPU 时间 (用户态 + 内核态，所有线程之和)，毫秒
+inline double ProcessCpuMilliseconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0.0;
+    auto to_ms = [](const FILETIME& t) {
+        return static_cast<double>((static_cast<std::uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime) / 1e4;
+    };
+    return to_ms(kernel) + to_ms(user);
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+#endif
+}
+
+// 调用线程已使用的 CPU 时间 (用户态 + 内核态)，毫秒
+inline double ThreadCpuMilliseconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) return 0.0;
+    auto to_ms = [](const FILETIME& t) {
+        return static_cast<double>((static_cast<std::uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime) / 1e4;
+    };
+    return to_ms(kernel) + to_ms(user);
+#else
+    timespec time{};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) return 0.0;
+    return time.tv_sec * 1e3 + time.tv_nsec / 1e6;
+#endif
+}
+
+// 进程的峰值常驻内存，字节
+inline std::uint64_t PeakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+/**
+ * 进程内的计时与计数统计，由 --stats=FILE 打开并在结束时写成 JSON。
+ * 同名的计时器累加调用次数与以下时间，同名的计数器累加数值，按首次出现的顺序输出:
+ *   wall_ms         墙钟时间
+ *   thread_cpu_ms   计时线程自身的 CPU 时间，不包含交给线程池的工作，不受同时运行的其他阶段影响
+ *   process_cpu_ms  阶段期间整个进程的 CPU 时间，包含线程池中的工作；批处理或服务器模式下同时运行的其他任务也计入其中
+ * 顶层的 process_cpu_ms 为进程结束时的总 CPU 时间。
+ * 未打开时 ScopedTimer 与 StatsCount 只读取一次原子标志，不做其他工作。
+ */
+class Stats {
+public:
+    static Stats& global() {
+        static Stats stats;
+        return stats;
+    }
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    void add_time(const char* name, double wall_ms, double thread_cpu_ms, double process_cpu_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& timer : timers_) {
+            if (timer.name == name) {
+                ++timer.calls;
+                timer.wall_ms += wall_ms;
+                timer.thread_cpu_ms += thread_cpu_ms;
+                timer.process_cpu_ms += process_cpu_ms;
+                return;
+            }
+        }
+        timers_.push_back({name, 1, wall_ms, thread_cpu_ms, process_cpu_ms});
+    }
+
+    void add_count(const char* name, std::uint64_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& counter : counters_) {
+            if (counter.name == name) {
+                counter.value += value;
+                return;
+            }
+        }
+        counters_.push_back({name, value});
+    }
+
+    // 记录 name 的最大值 (与 add_count 共用计数器)，用于单个瓦片或分组的峰值
+    void max_count(const char* name, std::uint64_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& counter : counters_) {
+            if (counter.name == name) {
+                counter.value = std::max(counter.value, value);
+                return;
+            }
+        }
+        counters_.push_back({name, value});
+    }
+
+    // 计数器当前的值，不存在时为 0
+    std::uint64_t count(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& counter : counters_) {
+            if (counter.name == name) return counter.value;
+        }
+        return 0;
+    }
+
+    // 清空所有计时器与计数器
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        timers_.clear();
+        counters_.clear();
+    }
+
+    bool write_json(const std::string& file_path) const {
+        std::ofstream out(file_path);
+        if (!out.is_open()) {
+            std::cerr << "Error: Unable to open stats file " << file_path << std::endl;
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        out << std::fixed << std::setprecision(3);
+        out << "{\n  \"peak_rss_bytes\": " << PeakResidentBytes() << ",\n  \"process_cpu_ms\": " << ProcessCpuMilliseconds()
+            << ",\n  \"timers\": {";
+        for (std::size_t i = 0; i < timers_.size(); ++i) {
+            const Timer& timer = timers_[i];
+            out << (i == 0 ? "\n" : ",\n") << "    \"" << timer.name << "\": {\"calls\": " << timer.calls
+                << ", \"wall_ms\": " << timer.wall_ms << ", \"thread_cpu_ms\": " << timer.thread_cpu_ms
+                << ", \"process_cpu_ms\": " << timer.process_cpu_ms << "}";
+        }
+        out << "\n  },\n  \"counters\": {";
+        for (std::size_t i = 0; i < counters_.size(); ++i) {
+            out << (i == 0 ? "\n" : ",\n") << "    \"" << counters_[i].name << "\": " << counters_[i].value;
+        }
+        out << "\n  }\n}\n";
+        return static_cast<bool>(out);
+    }
+
+private:
+    struct Timer {
+        std::string name;
+        std::uint64_t calls;
+        double wall_ms;
+        double thread_cpu_ms;
+        double process_cpu_ms;
+    };
+    struct Counter {
+        std::string name;
+        std::uint64_t value;
+    };
+
+    std::atomic<bool> enabled_{false};
+    mutable std::mutex mutex_;
+    std::vector<Timer> timers_;
+    std::vector<Counter> counters_;
+};
+
+// 作用域计时器，析构时把墙钟时间、当前线程与整个进程的 CPU 时间记到 name 下；name 须为字符串字面量
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name) : name_(Stats::global().enabled() ? name : nullptr) {
+        if (name_ == nullptr) return;
+        wall_start_ = std::chrono::steady_clock::now();
+        cpu_start_ = ThreadCpuMilliseconds();
+        process_cpu_start_ = ProcessCpuMilliseconds();
+    }
+    ~ScopedTimer() {
+        if (name_ == nullptr) return;
+        const double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start_).count();
+        Stats::global().add_time(name_, wall_ms, ThreadCpuMilliseconds() - cpu_start_, ProcessCpuMilliseconds() - process_cpu_start_);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const char* name_;
+    std::chrono::steady_clock::time_point wall_start_;
+    double cpu_start_ = 0.0;
+    double process_cpu_start_ = 0.0;
+};
+
+inline void StatsCount(const char* name, std::uint64_t value) {
+    if (Stats::global().enabled()) Stats::global().add_count(name, value);
+}
+
+inline void StatsMax(const char* name, std::uint64_t value) {
+    if (Stats::global().enabled()) Stats::global().max_count(name, value);
+}
+
+#endif //MESH_INTERSECTION_STATS_H
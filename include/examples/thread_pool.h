@@ -0,0 +1,163 @@
+//
+// Created by RainSure on 24-10-12.
+//
+
+#ifndef MESH_INTERSECTION_THREAD_POOL_H
+#define MESH_INTERSECTION_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "examples/parallel.h"
+
+/**
+ * 工作窃取线程池。
+ * 每个工作线程有自己的任务队列: 在工作线程中提交的任务放入本线程队列尾部，本线程从尾部取 (后进先出)，
+ * 空闲线程从其他队列头部窃取 (先进先出)；在池外提交的任务轮流分配到各队列。
+ * 任务抛出的第一个异常在 wait() 中重新抛出。
+ */
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned int num_threads = 0) {
+        num_threads = resolve_thread_count(num_threads);
+        for (unsigned int i = 0; i < num_threads; ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        threads_.reserve(num_threads);
+        for (unsigned int i = 0; i < num_threads; ++i) {
+            threads_.emplace_back([this, i]() { run(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    std::size_t size() const { return threads_.size(); }
+
+    void submit(std::function<void()> task) {
+        const std::size_t index = current_pool() == this ? current_index() : next_queue_++ % queues_.size();
+        {
+            // 先计数再入队，保证任务执行完之前 pending_ 已包含它
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++queued_;
+            ++pending_;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        }
+        wake_.notify_one();
+    }
+
+    // 等待所有已提交的任务 (包括任务中继续提交的任务) 完成
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this]() { return pending_ == 0; });
+        if (error_) {
+            std::exception_ptr error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    static WorkStealingPool*& current_pool() {
+        thread_local WorkStealingPool* pool = nullptr;
+        return pool;
+    }
+
+    static std::size_t& current_index() {
+        thread_local std::size_t index = 0;
+        return index;
+    }
+
+    bool pop(std::size_t index, std::function<void()>& task) {
+        // 先取自己队列尾部的任务，再从其他队列头部窃取
+        {
+            Queue& queue = *queues_[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                return true;
+            }
+        }
+        for (std::size_t k = 1; k < queues_.size(); ++k) {
+            Queue& queue = *queues_[(index + k) % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(std::size_t index) {
+        current_pool() = this;
+        current_index() = index;
+        for (;;) {
+            std::function<void()> task;
+            if (!pop(index, task)) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this]() { return queued_ > 0 || stop_; });
+                if (stop_ && queued_ == 0) return;
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --queued_;
+            }
+
+            std::exception_ptr error;
+            try {
+                task();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            task = nullptr;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (error && !error_) error_ = error;
+            if (--pending_ == 0) idle_.notify_all();
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    // queued_: 已提交但尚未被取走的任务数; pending_: 已提交但尚未执行完的任务数
+    std::size_t queued_ = 0;
+    std::size_t pending_ = 0;
+    std::atomic<std::size_t> next_queue_{0};
+    std::exception_ptr error_;
+    bool stop_ = false;
+};
+
+#endif //MESH_INTERSECTION_THREAD_POOL_H
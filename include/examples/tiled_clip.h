@@ -0,0 +1,407 @@
+//
+// Created by RainSure on 24-10-17.
+//
+
+#ifndef MESH_INTERSECTION_TILED_CLIP_H
+#define MESH_INTERSECTION_TILED_CLIP_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "examples/binary_mesh_io.h"
+#include "examples/co_refinement.h"
+#include "examples/mesh_data.h"
+#include "examples/stats.h"
+
+/**
+ * 分块 (out-of-core) 裁剪: mesh2 不整体读入内存，输入与输出均为文本格式。
+ *
+ * 1. 第一遍只读取 mesh1 (裁剪体)，构造 ClipCutter，裁剪体需能整体放入内存；
+ *    裁剪体的每个面按重心所在的瓦片分组；
+ * 2. 第二遍流式读取 mesh2: 包围盒与裁剪体包围盒不相交的三角形直接写入输出的 mesh2 部分，
+ *    其余三角形按重心落入的瓦片写入临时文件；
+ * 3. 逐个瓦片构造网格，与裁剪体中包围盒与瓦片交叠的原始面 (每个瓦片重新取出，互不影响) 共精细化，
+ *    删除裁剪体内部的面，结果追加到输出；与裁剪体某个面交叠的原始三角形按该面所在的分组写入另一组临时文件；
+ * 4. 逐个分组读回这些三角形，只与该组的裁剪体面共精细化，作为输出 mesh1 的一部分；没有交叠三角形的面原样输出。
+ *
+ * 瓦片之间的接缝保持一致: 与直接输出的三角形共享的边不与裁剪体相交，不会被分割；
+ * 两个瓦片共享的边在两侧都与裁剪体的同一批原始面求交，交点坐标相同，不会产生裂缝或 T 形连接。
+ * 裁剪体的分组之间同理: 穿过两组共享边的三角形与两侧的面都交叠，两组中都有，共享边在两侧的分割点相同。
+ * 内存峰值与裁剪体、单个瓦片中的三角形数、单个分组的交叠三角形数以及读块大小有关，与 mesh2 的总大小无关。
+ * 输出中 mesh2 的三角形顺序与输入不同: 先是直接输出的三角形，再按瓦片依次输出；mesh1 按分组依次输出。
+ */
+struct TiledClipOptions {
+    ClipOptions clip;
+    // 瓦片边长 (与坐标同单位)，0 表示取裁剪体包围盒最长边的 1/4
+    double tile_size = 0.0;
+    // 每个坐标轴上的瓦片数上限，超过时增大瓦片边长
+    std::size_t max_tiles_per_axis = 64;
+    // 每次从输入读取的字节数，同时也是瓦片与分组临时文件各自写缓冲的总大小
+    std::size_t block_size = std::size_t(64) << 20;
+    // 临时文件所在目录，空表示输出文件所在目录
+    std::string temp_dir;
+};
+
+static_assert(std::is_trivially_copyable_v<Triangle3D>, "tile spill files store Triangle3D as raw bytes");
+
+// 覆盖裁剪体包围盒的均匀瓦片网格，范围外的三角形归入最近的边缘瓦片
+struct TileGrid {
+    double origin[3] = {0.0, 0.0, 0.0};
+    double size = 1.0;
+    std::size_t dims[3] = {1, 1, 1};
+
+    TileGrid() = default;
+    TileGrid(const CGAL::Bbox_3& box, double tile_size, std::size_t max_tiles_per_axis) {
+        const double extent = std::max({box.xmax() - box.xmin(), box.ymax() - box.ymin(), box.zmax() - box.zmin()});
+        size = tile_size > 0.0 ? tile_size : extent / 4.0;
+        max_tiles_per_axis = std::max<std::size_t>(max_tiles_per_axis, 1);
+        if (!(size > 0.0)) size = 1.0;
+        if (extent / size > static_cast<double>(max_tiles_per_axis)) size = extent / static_cast<double>(max_tiles_per_axis);
+        for (int axis = 0; axis < 3; ++axis) {
+            origin[axis] = box.min(axis);
+            const double cells = std::ceil((box.max(axis) - box.min(axis)) / size);
+            dims[axis] = std::clamp<std::size_t>(static_cast<std::size_t>(cells), 1, max_tiles_per_axis);
+        }
+    }
+
+    std::size_t count() const { return dims[0] * dims[1] * dims[2]; }
+
+    std::size_t tile_of(const Triangle3D& triangle) const {
+        const auto& p = triangle.points;
+        const double centroid[3] = {(p[0].x + p[1].x + p[2].x) / 3.0, (p[0].y + p[1].y + p[2].y) / 3.0, (p[0].z + p[1].z + p[2].z) / 3.0};
+        std::size_t cell[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            const double t = std::floor((centroid[axis] - origin[axis]) / size);
+            cell[axis] = t <= 0.0 ? 0 : std::min(static_cast<std::size_t>(t), dims[axis] - 1);
+        }
+        return (cell[2] * dims[1] + cell[1]) * dims[0] + cell[0];
+    }
+};
+
+inline bool triangle_overlaps_box(const Triangle3D& triangle, const CGAL::Bbox_3& box) {
+    const auto& p = triangle.points;
+    return std::max({p[0].x, p[1].x, p[2].x}) >= box.xmin() && std::min({p[0].x, p[1].x, p[2].x}) <= box.xmax() &&
+           std::max({p[0].y, p[1].y, p[2].y}) >= box.ymin() && std::min({p[0].y, p[1].y, p[2].y}) <= box.ymax() &&
+           std::max({p[0].z, p[1].z, p[2].z}) >= box.zmin() && std::min({p[0].z, p[1].z, p[2].z}) <= box.zmax();
+}
+
+/**
+ * 各瓦片三角形的临时文件。三角形先缓存在内存中，缓存总量超过 budget 字节时全部追加写入各自的文件。
+ */
+class TileSpill {
+public:
+    TileSpill(std::filesystem::path dir, std::size_t num_tiles, std::size_t budget)
+            : dir_(std::move(dir))
+            , buffers_(num_tiles)
+            , counts_(num_tiles, 0)
+            , budget_(std::max<std::size_t>(budget / sizeof(Triangle3D), 1)) {}
+
+    bool add(std::size_t tile, const Triangle3D& triangle) {
+        buffers_[tile].push_back(triangle);
+        ++counts_[tile];
+        return ++buffered_ < budget_ || flush();
+    }
+
+    bool flush() {
+        for (std::size_t tile = 0; tile < buffers_.size(); ++tile) {
+            auto& buffer = buffers_[tile];
+            if (buffer.empty()) continue;
+            std::ofstream out(path(tile), std::ios::binary | std::ios::app);
+            out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(Triangle3D)));
+            if (!out) {
+                std::cerr << "Error: Failed to write tile file " << path(tile).string() << std::endl;
+                return false;
+            }
+            buffer.clear();
+            buffer.shrink_to_fit();
+        }
+        buffered_ = 0;
+        return true;
+    }
+
+    std::size_t num_tiles() const { return counts_.size(); }
+    std::uint64_t count(std::size_t tile) const { return counts_[tile]; }
+
+    // 读取一个瓦片的全部三角形 (须先 flush)，读完后删除其临时文件
+    bool read(std::size_t tile, std::vector<Triangle3D>& triangles) const {
+        triangles.resize(counts_[tile]);
+        std::ifstream in(path(tile), std::ios::binary);
+        in.read(reinterpret_cast<char*>(triangles.data()), static_cast<std::streamsize>(triangles.size() * sizeof(Triangle3D)));
+        if (!in) {
+            std::cerr << "Error: Failed to read tile file " << path(tile).string() << std::endl;
+            return false;
+        }
+        in.close();
+        std::error_code ec;
+        std::filesystem::remove(path(tile), ec);
+        return true;
+    }
+
+private:
+    std::filesystem::path path(std::size_t tile) const {
+        return dir_ / ("tile_" + std::to_string(tile) + ".bin");
+    }
+
+    std::filesystem::path dir_;
+    std::vector<std::vector<Triangle3D>> buffers_;
+    std::vector<std::uint64_t> counts_;
+    std::size_t budget_;
+    std::size_t buffered_ = 0;
+};
+
+// 逐块格式化三角形并写入文件，与 WriteMeshData 的格式相同
+class TextTriangleWriter {
+public:
+    explicit TextTriangleWriter(std::ofstream& out) : out_(out) {
+        buffer_.reserve(flush_size + 256);
+    }
+    ~TextTriangleWriter() { flush(); }
+
+    void add(const Triangle3D& triangle) {
+        for (const auto& point : triangle.points) {
+            append_text_point(buffer_, point);
+        }
+        if (buffer_.size() >= flush_size) flush();
+    }
+    void add(const Point3D& point) {
+        append_text_point(buffer_, point);
+        if (buffer_.size() >= flush_size) flush();
+    }
+    void add(const char* text) { buffer_ += text; }
+
+    void flush() {
+        out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+
+private:
+    static constexpr std::size_t flush_size = std::size_t(4) << 20;
+    std::ofstream& out_;
+    std::string buffer_;
+};
+
+// 删除临时目录
+struct TempDirectory {
+    explicit TempDirectory(std::filesystem::path p) : path(std::move(p)) {}
+    ~TempDirectory() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+    std::filesystem::path path;
+};
+
+/**
+ * 分块裁剪文本格式的 input_file 并写入 output_file，输出格式与 WriteMeshData 相同。
+ * 只支持文本格式: .mbin 文件需要整体解码，不适合流式处理。
+ */
+inline bool ClipMeshFileTiled(const std::string& input_file, const std::string& output_file, const TiledClipOptions& options = TiledClipOptions()) {
+    ScopedTimer timer("clip_mesh_tiled");
+    if (IsBinaryMeshFile(input_file) || IsBinaryMeshFile(output_file)) {
+        std::cerr << "Error: tiled clipping only supports text mesh files" << std::endl;
+        return false;
+    }
+
+    // 第一遍: 读取裁剪体，跳过 mesh2
+    MeshData cutter_data;
+    {
+        ScopedTimer read_timer("read_cutter");
+        MeshDataStream stream(input_file, options.block_size);
+        MeshData skipped;
+        while (stream.next(cutter_data, skipped)) {
+            skipped.triangles.clear();
+        }
+        if (stream.failed()) return false;
+    }
+    StatsCount("input_faces_mesh1", cutter_data.triangles.size());
+
+    Mesh cutter_mesh;
+    BuildMesh(cutter_data.triangles, cutter_mesh, options.clip);
+    cutter_data.triangles = std::vector<Triangle3D>();
+    if (cutter_mesh.number_of_faces() == 0 || !CGAL::is_triangle_mesh(cutter_mesh) || !CGAL::is_closed(cutter_mesh)) {
+        std::cerr << "Error: mesh1 is not a closed triangle mesh" << std::endl;
+        return false;
+    }
+    const ClipCutter cutter(std::move(cutter_mesh));
+    const CGAL::Bbox_3 cutter_box = PMP::bbox(cutter.mesh);
+    const TileGrid grid(cutter_box, options.tile_size, options.max_tiles_per_axis);
+
+    // 裁剪体的面按重心所在的瓦片分组，各组的面按编号排序
+    std::vector<std::uint32_t> cutter_group(cutter.mesh.num_faces(), 0);
+    std::vector<std::vector<Face_index>> group_faces(grid.count());
+    for (Face_index f : cutter.mesh.faces()) {
+        cutter_group[f.idx()] = static_cast<std::uint32_t>(grid.tile_of(face_triangle(cutter.mesh, f)));
+        group_faces[cutter_group[f.idx()]].push_back(f);
+    }
+
+    const std::filesystem::path output_path(output_file);
+    const std::filesystem::path temp_parent = options.temp_dir.empty() ? output_path.parent_path() : std::filesystem::path(options.temp_dir);
+    TempDirectory temp(temp_parent / (output_path.filename().string() + ".tiles"));
+    std::error_code ec;
+    std::filesystem::create_directories(temp.path / "contact", ec);
+    if (ec) {
+        std::cerr << "Error: Unable to create temporary directory " << temp.path.string() << std::endl;
+        return false;
+    }
+
+    // mesh2 的输出先写入临时文件，最后接在共精细化后的裁剪体之后
+    const std::filesystem::path mesh2_path = temp.path / "mesh2.txt";
+    std::ofstream mesh2_out(mesh2_path, std::ios::binary);
+    if (!mesh2_out.is_open()) {
+        std::cerr << "Error: Unable to open temporary file " << mesh2_path.string() << std::endl;
+        return false;
+    }
+    TextTriangleWriter mesh2_writer(mesh2_out);
+
+    // 第二遍: 流式读取 mesh2，直接输出与裁剪体包围盒不相交的三角形，其余按瓦片写入临时文件
+    TileSpill spill(temp.path, grid.count(), options.block_size);
+    {
+        ScopedTimer partition_timer("partition_tiles");
+        MeshDataStream stream(input_file, options.block_size);
+        MeshData skipped, block;
+        std::uint64_t passthrough = 0, tiled = 0;
+        while (stream.next(skipped, block)) {
+            skipped.triangles.clear();
+            for (const auto& triangle : block.triangles) {
+                if (!triangle_overlaps_box(triangle, cutter_box)) {
+                    mesh2_writer.add(triangle);
+                    ++passthrough;
+                } else if (!spill.add(grid.tile_of(triangle), triangle)) {
+                    return false;
+                } else {
+                    ++tiled;
+                }
+            }
+            block.triangles.clear();
+        }
+        if (stream.failed() || !spill.flush()) return false;
+        StatsCount("input_faces_mesh2", passthrough + tiled);
+        StatsCount("passthrough_faces", passthrough);
+        StatsCount("tiled_faces", tiled);
+    }
+
+    // 逐个瓦片裁剪，每个瓦片只与裁剪体中与其交叠的原始面共精细化；
+    // 与裁剪体的面交叠的原始三角形按面所在的分组写入临时文件，用于第 4 步
+    TileSpill contact(temp.path / "contact", grid.count(), options.block_size);
+    VertexWelder boundary(0.0);
+    std::vector<Triangle3D> triangles;
+    for (std::size_t tile = 0; tile < spill.num_tiles(); ++tile) {
+        if (spill.count(tile) == 0) continue;
+        ScopedTimer tile_timer("clip_tile");
+        StatsCount("tiles", 1);
+        StatsMax("max_tile_faces", spill.count(tile));
+        if (!spill.read(tile, triangles)) return false;
+
+        // BuildMesh 按输入顺序加入面，面的编号即 triangles 中的下标
+        Mesh tile_mesh;
+        BuildMesh(triangles, tile_mesh, options.clip);
+        auto constrained = tile_mesh.add_property_map<Edge_index, bool>("e:constrained", false).first;
+        std::vector<Face_index> cutter_faces;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> contact_faces;
+        for_each_overlapping_face_pair(cutter.mesh, tile_mesh, [&](Face_index cutter_face, Face_index tile_face) {
+            cutter_faces.push_back(cutter_face);
+            contact_faces.emplace_back(cutter_group[cutter_face.idx()], static_cast<std::uint32_t>(tile_face.idx()));
+        });
+        if (!cutter_faces.empty()) {
+            std::sort(cutter_faces.begin(), cutter_faces.end());
+            cutter_faces.erase(std::unique(cutter_faces.begin(), cutter_faces.end()), cutter_faces.end());
+            std::sort(contact_faces.begin(), contact_faces.end());
+            contact_faces.erase(std::unique(contact_faces.begin(), contact_faces.end()), contact_faces.end());
+            for (const auto& [group, tile_face] : contact_faces) {
+                if (!contact.add(group, triangles[tile_face])) return false;
+            }
+            StatsCount("contact_faces", contact_faces.size());
+
+            LocalPatch<K> cutter_patch;
+            extract_patch(cutter.mesh, cutter_faces, cutter_patch);
+            corefine_meshes(cutter_patch.mesh, tile_mesh, options.clip.local_corefine, &constrained);
+        }
+
+        std::vector<K::Point_3> tile_boundary;
+        boundary_polylines(tile_mesh, constrained, tile_boundary);
+        for (const auto& point : tile_boundary) {
+            boundary.insert(Point3D(point.x(), point.y(), point.z()));
+        }
+        clip_inside_faces(tile_mesh, cutter.tree, constrained, options.clip);
+
+        MeshToTriangles(tile_mesh, triangles);
+        for (const auto& triangle : triangles) {
+            mesh2_writer.add(triangle);
+        }
+    }
+    triangles = std::vector<Triangle3D>();
+    mesh2_writer.flush();
+    mesh2_out.close();
+    if (!mesh2_out) {
+        std::cerr << "Error: Failed to write temporary file " << mesh2_path.string() << std::endl;
+        return false;
+    }
+    if (!contact.flush()) return false;
+    StatsCount("boundary_points", boundary.points().size());
+
+    std::ofstream outfile(output_file, std::ios::binary);
+    if (!outfile.is_open()) {
+        std::cerr << "Error: Unable to open output file " << output_file << std::endl;
+        return false;
+    }
+
+    // 逐个分组共精细化裁剪体并输出: 与组内的面相交的三角形都在该组的临时文件中，每个细分后的面只输出一次
+    {
+        TextTriangleWriter writer(outfile);
+        writer.add("mesh1:\n");
+        std::uint64_t refined_faces = 0;
+        std::vector<Triangle3D> group_contact;
+        for (std::size_t group = 0; group < group_faces.size(); ++group) {
+            const auto& faces = group_faces[group];
+            if (contact.count(group) == 0) {
+                for (Face_index f : faces) {
+                    writer.add(face_triangle(cutter.mesh, f));
+                }
+                refined_faces += faces.size();
+                continue;
+            }
+            ScopedTimer refine_timer("refine_cutter");
+            if (!contact.read(group, group_contact)) return false;
+            StatsMax("max_group_contact_faces", group_contact.size());
+            LocalPatch<K> cutter_patch;
+            extract_patch(cutter.mesh, faces, cutter_patch);
+            Mesh contact_mesh;
+            BuildMesh(group_contact, contact_mesh, options.clip);
+            corefine_meshes(cutter_patch.mesh, contact_mesh, options.clip.local_corefine);
+            for (Face_index f : cutter_patch.mesh.faces()) {
+                writer.add(face_triangle(cutter_patch.mesh, f));
+            }
+            refined_faces += cutter_patch.mesh.number_of_faces();
+        }
+        StatsCount("faces_after_corefine_mesh1", refined_faces);
+        writer.add("mesh2:\n");
+    }
+
+    // 输出其余部分: mesh2 临时文件的内容、边界点
+    ScopedTimer write_timer("write_mesh_data");
+    {
+        std::ifstream mesh2_in(mesh2_path, std::ios::binary);
+        if (mesh2_in.peek() != std::ifstream::traits_type::eof()) outfile << mesh2_in.rdbuf();
+    }
+    {
+        TextTriangleWriter writer(outfile);
+        writer.add("boundary_points:\n");
+        for (const auto& point : boundary.points()) {
+            writer.add(point);
+        }
+    }
+    if (!outfile) {
+        std::cerr << "Error: Failed to write output file " << output_file << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#endif //MESH_INTERSECTION_TILED_CLIP_H
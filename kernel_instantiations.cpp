@@ -0,0 +1,32 @@
+//
+// Created by RainSure on 24-10-20.
+//
+
+#include "examples/co_refinement.h"
+#include "examples/intersection_line.h"
+#include "examples/mesh_intersection.h"
+#include "examples/multi_clip.h"
+
+/**
+ * 以内核为模板参数的各流程在此显式实例化，头文件中对应的 extern template 声明使其余翻译单元不再各自实例化。
+ * 共精细化、裁剪与布尔运算只支持精确谓词的内核 (K、EK)，求交线另外支持 FK。
+ */
+
+template std::vector<CGAL::Point_3<K>> co_refinement_and_clip<K>(Kernel_mesh<K>&, Kernel_mesh<K>&, const std::string&, const std::string&,
+                                                                 const ClipOptions&, std::vector<Boundary_polyline<K>>*);
+template std::vector<CGAL::Point_3<EK>> co_refinement_and_clip<EK>(Kernel_mesh<EK>&, Kernel_mesh<EK>&, const std::string&, const std::string&,
+                                                                   const ClipOptions&, std::vector<Boundary_polyline<EK>>*);
+template std::vector<Point3D> ClipMesh<K>(std::vector<Triangle3D>&, std::vector<Triangle3D>&, const ClipOptions&);
+template std::vector<Point3D> ClipMesh<EK>(std::vector<Triangle3D>&, std::vector<Triangle3D>&, const ClipOptions&);
+template bool ClipMesh<K>(const MeshBufferView&, const MeshBufferView&, MeshBuffers&, MeshBuffers&, PointBuffers&, const ClipOptions&);
+template bool ClipMesh<EK>(const MeshBufferView&, const MeshBufferView&, MeshBuffers&, MeshBuffers&, PointBuffers&, const ClipOptions&);
+
+template bool ClipMeshMulti<K>(std::vector<std::vector<Triangle3D>>&, std::vector<Triangle3D>&, std::vector<std::vector<Point3D>>&, const ClipOptions&);
+template bool ClipMeshMulti<EK>(std::vector<std::vector<Triangle3D>>&, std::vector<Triangle3D>&, std::vector<std::vector<Point3D>>&, const ClipOptions&);
+
+template std::array<bool, 4> boolean_operations<K>(Kernel_mesh<K>&, Kernel_mesh<K>&, const Kernel_boolean_outputs<K>&);
+template std::array<bool, 4> boolean_operations<EK>(Kernel_mesh<EK>&, Kernel_mesh<EK>&, const Kernel_boolean_outputs<EK>&);
+
+template std::vector<CGAL::Segment_3<K>> intersection_segments<K>(const Kernel_mesh<K>&, const Kernel_mesh<K>&, const Intersection_line_options&);
+template std::vector<CGAL::Segment_3<EK>> intersection_segments<EK>(const Kernel_mesh<EK>&, const Kernel_mesh<EK>&, const Intersection_line_options&);
+template std::vector<CGAL::Segment_3<FK>> intersection_segments<FK>(const Kernel_mesh<FK>&, const Kernel_mesh<FK>&, const Intersection_line_options&);
@@ -1,18 +1,20 @@
-#include <CGAL/Simple_cartesian.h>
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/Surface_mesh.h>
 #include <CGAL/Polygon_mesh_processing/intersection.h>
 #include <CGAL/IO/PLY.h>
+#include <stdexcept>
 #include <vector>
 #include <fstream>
 #include <iostream>
 #include <unordered_set>
+#include "examples/batch.h"
+#include "examples/binary_mesh_io.h"
+#include "examples/clip_server.h"
 #include "examples/co_refinement.h"
-typedef CGAL::Exact_predicates_inexact_constructions_kernel K;
-typedef K::Point_3 Point_3;
-typedef K::Segment_3 Segment_3;
-typedef K::Triangle_3 Triangle_3;
-typedef CGAL::Surface_mesh<Point_3> Mesh;
+#include "examples/intersection_line.h"
+#include "examples/kernels.h"
+#include "examples/mesh_intersection.h"
+#include "examples/multi_clip.h"
+#include "examples/stats.h"
+#include "examples/tiled_clip.h"
 namespace PMP = CGAL::Polygon_mesh_processing;
 
 /**
@@ -43,6 +45,48 @@ namespace PMP = CGAL::Polygon_mesh_processing;
  * point2: x, y, z
  * point3: x, y, z
  *
+ * 以 .mbin 结尾的输入/输出文件使用二进制格式 (见 binary_mesh_io.h)，通过内存映射读取，
+ * 文件中的索引网格直接用于构造网格，不再展开为三角形后重新焊接。
+ *
+ * clip 选项:
+ * --weld-tolerance=D  焊接距离不超过 D 的顶点（默认 0，只合并坐标完全相同的点）
+ * --no-weld           不焊接顶点，每个三角形单独构造
+ * --threads=N         文本解析与点定位使用的线程数（0 表示使用全部硬件线程）
+ * --local-corefine    只对两网格交叠区域内的面做共精细化，再拼回其余部分
+ * --vertex-classification  对每个顶点做点定位 (默认每个由交线围成的面片只做一次)
+ * --kernel=NAME       构造网格所用的内核: epick (默认) 或 epeck (精确构造，最稳健)；
+ *                     float 的谓词不精确，不能用于共精细化，只有 intersection_line 接受
+ *
+ * intersection_line 子命令:
+ * mesh_intersection intersection_line <mesh1.ply> <mesh2.ply> <output.ply> [--all-pairs] [--no-prefilter] [--threads=N] [--binary] [--polylines] [--kernel=NAME]
+ *
+ * boolean 子命令 (一次共精细化同时得到所有指定的结果，输入必须是封闭网格):
+ * mesh_intersection boolean <mesh1> <mesh2> [--union=FILE] [--intersection=FILE] [--mesh1-minus-mesh2=FILE] [--mesh2-minus-mesh1=FILE] [--kernel=NAME]
+ *
+ * serve 子命令 (常驻裁剪服务，协议见 clip_server.h):
+ * mesh_intersection serve [--socket=PATH] [--cutter=NAME:FILE]... [--max-frame-size=BYTES] [clip 选项]
+ * 不指定 --socket 时从标准输入读取请求、向标准输出写响应；--cutter 预先注册 FILE 中的 mesh1 为裁剪体 NAME
+ * 收到关闭服务的请求 (或套接字模式下收到 SIGINT/SIGTERM) 时，等待正在处理的请求完成、删除套接字文件后正常退出，--stats 照常写出
+ *
+ * serve 与 tiled 的裁剪体预先构造，固定使用 epick 内核。
+ *
+ * tiled 子命令 (分块裁剪，mesh2 不整体读入内存，只支持文本格式，见 tiled_clip.h):
+ * mesh_intersection tiled <input_file> <output_file> [--tile-size=D] [--block-size=MB] [--temp-dir=DIR] [clip 选项]
+ * --tile-size 为瓦片边长 (默认取裁剪体包围盒最长边的 1/4)，--block-size 为读块与瓦片写缓冲的大小 (MB)
+ *
+ * multi_clip 子命令 (一次裁剪掉多个封闭的裁剪体，见 multi_clip.h):
+ * mesh_intersection multi_clip <input_file> <output_file> [--cutter=FILE]... [clip 选项]
+ * input_file 的 mesh1 为第一个裁剪体、mesh2 为被裁剪的网格，每个 --cutter 的 mesh1 依次为其后的裁剪体。
+ * 输出的 mesh1 为按顺序连接的各个共精细化后的裁剪体，boundary_points 为按裁剪体顺序连接的交线点，
+ * 各裁剪体共精细化后的面数与交线点数记入 --stats (cutter_<c>_faces、cutter_<c>_boundary_points)。
+ *
+ * batch 子命令 (清单格式见 batch.h):
+ * mesh_intersection batch <manifest> [--threads=N] [--in-flight=N] [clip 选项]
+ * 清单中的作业在工作窃取线程池上运行，--threads 为线程池大小，--in-flight 为同时在途的作业数上限
+ *
+ * 所有命令都接受 --stats=FILE: 结束时把各阶段的墙钟时间与计时线程的 CPU 时间、进程的总 CPU 时间、计数 (输入面数、共精细化后的面数、
+ * 点定位次数、删除的面数、边界点数等) 与峰值常驻内存写成 JSON 文件 FILE
+ *
  * @param argc
  * @param argv
  * @return
@@ -50,26 +94,296 @@ namespace PMP = CGAL::Polygon_mesh_processing;
 
 
 
-int main(int argc, char* argv[]) {
-    if (argc < 3) {
-        std::cerr << "Usage: " << argv[0] << " <input_file> <output_file>" << std::endl;
+// 解析 clip 相关的选项，不是 clip 选项时返回 false；选项的值无效时抛出 std::invalid_argument (由 main 报告)
+static bool ParseClipOption(const std::string& arg, ClipOptions& options) {
+    if (arg == "--no-weld") {
+        options.weld_vertices = false;
+    } else if (arg.rfind("--weld-tolerance=", 0) == 0) {
+        options.weld_tolerance = std::stod(arg.substr(17));
+    } else if (arg.rfind("--threads=", 0) == 0) {
+        options.num_threads = static_cast<unsigned int>(std::stoul(arg.substr(10)));
+    } else if (arg == "--local-corefine") {
+        options.local_corefine = true;
+    } else if (arg == "--vertex-classification") {
+        options.vertex_classification = true;
+    } else if (arg.rfind("--kernel=", 0) == 0) {
+        if (!ParseMeshKernel(arg.substr(9), options.kernel) || !IsCorefinementKernel(options.kernel)) {
+            throw std::invalid_argument("unsupported kernel " + arg.substr(9) + " (expected epick or epeck)");
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static int Boolean(int argc, char* argv[]) {
+    BooleanOptions options;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (!ParseBooleanOption(arg, options)) inputs.push_back(arg);
+    }
+
+    if (inputs.size() != 2 || !HasBooleanOutput(options)) {
+        std::cerr << "Usage: boolean <mesh1> <mesh2> [--union=FILE] [--intersection=FILE] [--mesh1-minus-mesh2=FILE] [--mesh2-minus-mesh1=FILE] [--kernel=NAME]" << std::endl;
+        return 1;
+    }
+    return dispatch_exact_kernel(options.kernel, [&](auto tag) {
+        Kernel_mesh<decltype(tag)> mesh1, mesh2;
+        if (!PMP::IO::read_polygon_mesh(inputs[0], mesh1) || !PMP::IO::read_polygon_mesh(inputs[1], mesh2)) {
+            std::cerr << "Error: Unable to read " << inputs[0] << " or " << inputs[1] << std::endl;
+            return 1;
+        }
+        return boolean_operations(mesh1, mesh2, options.output_files) ? 0 : 1;
+    });
+}
+
+static int Batch(int argc, char* argv[]) {
+    BatchOptions options;
+    std::string manifest;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--threads=", 0) == 0) {
+            options.num_threads = static_cast<unsigned int>(std::stoul(arg.substr(10)));
+        } else if (arg.rfind("--in-flight=", 0) == 0) {
+            options.max_jobs_in_flight = std::stoul(arg.substr(12));
+        } else if (ParseClipOption(arg, options.clip)) {
+            continue;
+        } else if (manifest.empty()) {
+            manifest = arg;
+        } else {
+            std::cerr << "Error: Unknown batch option " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<BatchJob> jobs;
+    if (manifest.empty() || !ReadBatchManifest(manifest, jobs, options.clip.kernel)) {
+        std::cerr << "Usage: batch <manifest> [--threads=N] [--in-flight=N] [clip options]" << std::endl;
         return 1;
     }
+    return RunBatch(jobs, options) == 0 ? 0 : 1;
+}
+
+static int Serve(int argc, char* argv[]) {
+    ClipOptions options;
+    std::string socket_path;
+    std::uint64_t max_frame_size = kDefaultMaxClipFrameSize;
+    std::vector<std::pair<std::string, std::string>> cutter_files;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (ParseClipOption(arg, options)) {
+            continue;
+        } else if (arg.rfind("--max-frame-size=", 0) == 0) {
+            max_frame_size = std::stoull(arg.substr(17));
+        } else if (arg.rfind("--socket=", 0) == 0) {
+            socket_path = arg.substr(9);
+        } else if (arg.rfind("--cutter=", 0) == 0 && arg.find(':', 9) != std::string::npos) {
+            const std::size_t colon = arg.find(':', 9);
+            cutter_files.emplace_back(arg.substr(9, colon - 9), arg.substr(colon + 1));
+        } else {
+            std::cerr << "Error: Unknown serve option " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    ClipServer server(options, max_frame_size);
+    for (const auto& [name, file] : cutter_files) {
+        MeshData mesh1, mesh2;
+        std::string error;
+        if (!ReadMeshFile(file, mesh1, mesh2, options.num_threads)) {
+            return 1;
+        }
+        if (!server.register_cutter(name, mesh1.triangles, error)) {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+        std::cerr << "Registered cutter " << name << " from " << file << std::endl;
+    }
 
-    std::string input_file = argv[1];
-    std::string output_file = argv[2];
+    if (socket_path.empty()) {
+        ServeClipStdio(server);
+        return 0;
+    }
+    return ServeClipUnixSocket(server, socket_path) ? 0 : 1;
+}
+
+static int Tiled(int argc, char* argv[]) {
+    TiledClipOptions options;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (ParseClipOption(arg, options.clip)) {
+            continue;
+        } else if (arg.rfind("--tile-size=", 0) == 0) {
+            options.tile_size = std::stod(arg.substr(12));
+        } else if (arg.rfind("--block-size=", 0) == 0) {
+            options.block_size = std::stoul(arg.substr(13)) << 20;
+        } else if (arg.rfind("--temp-dir=", 0) == 0) {
+            options.temp_dir = arg.substr(11);
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.size() != 2) {
+        std::cerr << "Usage: tiled <input_file> <output_file> [--tile-size=D] [--block-size=MB] [--temp-dir=DIR] [clip options]" << std::endl;
+        return 1;
+    }
+    return ClipMeshFileTiled(files[0], files[1], options) ? 0 : 1;
+}
+
+static int MultiClip(int argc, char* argv[]) {
+    ClipOptions options;
+    std::vector<std::string> files;
+    std::vector<std::string> cutter_files;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (ParseClipOption(arg, options)) {
+            continue;
+        } else if (arg.rfind("--cutter=", 0) == 0) {
+            cutter_files.push_back(arg.substr(9));
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.size() != 2) {
+        std::cerr << "Usage: multi_clip <input_file> <output_file> [--cutter=FILE]... [clip options]" << std::endl;
+        return 1;
+    }
+    MeshData mesh1, mesh2;
+    if (!ReadMeshFile(files[0], mesh1, mesh2, options.num_threads)) {
+        return 1;
+    }
+    std::vector<std::vector<Triangle3D>> cutters(1, std::move(mesh1.triangles));
+    for (const auto& file : cutter_files) {
+        MeshData cutter, unused;
+        if (!ReadMeshFile(file, cutter, unused, options.num_threads)) {
+            return 1;
+        }
+        cutters.push_back(std::move(cutter.triangles));
+    }
+
+    std::vector<std::vector<Point3D>> boundary_points;
+    if (!ClipMeshMulti(cutters, mesh2.triangles, boundary_points, options)) {
+        return 1;
+    }
+
+    MeshData refined_cutters;
+    std::vector<Point3D> all_points;
+    for (std::size_t c = 0; c < cutters.size(); ++c) {
+        refined_cutters.triangles.insert(refined_cutters.triangles.end(), cutters[c].begin(), cutters[c].end());
+        all_points.insert(all_points.end(), boundary_points[c].begin(), boundary_points[c].end());
+        const std::string prefix = "cutter_" + std::to_string(c);
+        StatsCount((prefix + "_faces").c_str(), cutters[c].size());
+        StatsCount((prefix + "_boundary_points").c_str(), boundary_points[c].size());
+    }
+    return WriteMeshFile(files[1], refined_cutters, mesh2, all_points) ? 0 : 1;
+}
+
+static int Run(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "intersection_line") {
+        return intersection_line(argc - 1, argv + 1) ? 0 : 1;
+    }
+    if (argc > 1 && std::string(argv[1]) == "boolean") {
+        return Boolean(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "serve") {
+        return Serve(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "tiled") {
+        return Tiled(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "multi_clip") {
+        return MultiClip(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "batch") {
+        return Batch(argc - 1, argv + 1);
+    }
+
+    std::vector<std::string> files;
+    ClipOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (!ParseClipOption(arg, options)) {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.size() < 2) {
+        std::cerr << "Usage: " << argv[0] << " <input_file> <output_file> [--weld-tolerance=D] [--no-weld] [--threads=N] [--local-corefine] [--vertex-classification] [--kernel=NAME]" << std::endl;
+        std::cerr << "       " << argv[0] << " intersection_line <mesh1.ply> <mesh2.ply> <output.ply> [--all-pairs] [--no-prefilter] [--threads=N] [--binary] [--polylines] [--kernel=NAME]" << std::endl;
+        std::cerr << "       " << argv[0] << " boolean <mesh1> <mesh2> [--union=FILE] [--intersection=FILE] [--mesh1-minus-mesh2=FILE] [--mesh2-minus-mesh1=FILE] [--kernel=NAME]" << std::endl;
+        std::cerr << "       " << argv[0] << " serve [--socket=PATH] [--cutter=NAME:FILE]... [--max-frame-size=BYTES] [clip options]" << std::endl;
+        std::cerr << "       " << argv[0] << " tiled <input_file> <output_file> [--tile-size=D] [--block-size=MB] [--temp-dir=DIR] [clip options]" << std::endl;
+        std::cerr << "       " << argv[0] << " multi_clip <input_file> <output_file> [--cutter=FILE]... [clip options]" << std::endl;
+        std::cerr << "       " << argv[0] << " batch <manifest> [--threads=N] [--in-flight=N] [clip options]" << std::endl;
+        std::cerr << "All commands accept --stats=FILE to write stage timings and counters as JSON." << std::endl;
+        return 1;
+    }
+
+    std::string input_file = files[0];
+    std::string output_file = files[1];
+
+    // .mbin 输入已按坐标合并顶点，索引数据直接交给 SoA 版本的 ClipMesh；
+    // 指定了 --weld-tolerance 或 --no-weld 时仍展开为三角形，按选项重新构造
+    if (IsBinaryMeshFile(input_file) && options.weld_vertices && options.weld_tolerance == 0.0) {
+        MeshBuffers mesh1, mesh2;
+        PointBuffers boundary;
+        if (!ReadMeshBuffersBinary(input_file, mesh1, mesh2) ||
+            !ClipMesh(mesh1.view(), mesh2.view(), mesh1, mesh2, boundary, options)) {
+            return 1;
+        }
+        return WriteMeshBuffersFile(output_file, mesh1, mesh2, boundary) ? 0 : 1;
+    }
 
     // Read input mesh data
     MeshData mesh1, mesh2;
-    if (!ReadMeshData(input_file, mesh1, mesh2)) {
+    if (!ReadMeshFile(input_file, mesh1, mesh2, options.num_threads)) {
         return 1;
     }
 
     // Perform mesh clipping
-    std::vector<Point3D> boundary_points = ClipMesh(mesh1.triangles, mesh2.triangles);
+    std::vector<Point3D> boundary_points = ClipMesh(mesh1.triangles, mesh2.triangles, options);
 
     // Write output mesh data
-    WriteMeshData(output_file, mesh1, mesh2, boundary_points);
+    if (!WriteMeshFile(output_file, mesh1, mesh2, boundary_points)) {
+        return 1;
+    }
 
     return 0;
 }
+
+int main(int argc, char* argv[]) {
+    // --stats=FILE 对所有命令有效，先从参数中取出
+    std::string stats_file;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i > 0 && arg.rfind("--stats=", 0) == 0) {
+            stats_file = arg.substr(8);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    if (!stats_file.empty()) {
+        Stats::global().set_enabled(true);
+    }
+
+    // 选项的值无效 (数字格式错误、不支持的内核等) 时报告错误，而不是异常终止
+    int status = 1;
+    try {
+        status = Run(static_cast<int>(args.size()), args.data());
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Error: Invalid option: " << e.what() << std::endl;
+    } catch (const std::out_of_range& e) {
+        std::cerr << "Error: Option value out of range: " << e.what() << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+    }
+    if (!stats_file.empty() && !Stats::global().write_json(stats_file)) {
+        status = 1;
+    }
+    return status;
+}
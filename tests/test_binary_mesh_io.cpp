@@ -0,0 +1,139 @@
+//
+// Created by RainSure on 24-10-20.
+//
+
+#include "examples/binary_mesh_io.h"
+#include "test_util.h"
+
+/**
+ * .mbin 格式: 写出再读入后三角形逐位相同，共享顶点只存一次，索引数据可直接读入 SoA 缓冲区，损坏或截断的文件被拒绝。
+ */
+
+namespace {
+
+MeshData make_strip(double z, std::size_t count) {
+    MeshData mesh;
+    for (std::size_t i = 0; i < count; ++i) {
+        const double x = static_cast<double>(i) * 0.125;
+        mesh.triangles.emplace_back(Point3D(x, 0, z), Point3D(x + 0.125, 0, z), Point3D(x, 1.0 / 3.0, z));
+        mesh.triangles.emplace_back(Point3D(x + 0.125, 0, z), Point3D(x + 0.125, 1.0 / 3.0, z), Point3D(x, 1.0 / 3.0, z));
+    }
+    return mesh;
+}
+
+void test_round_trip() {
+    MeshData mesh1 = make_strip(0.5, 50);
+    MeshData mesh2 = make_strip(-2.0, 20);
+    // 极小与极大的坐标原样保存
+    mesh2.triangles.emplace_back(Point3D(0, 0, 0), Point3D(1e-300, 0, 0), Point3D(0, 1e300, 0));
+    const std::vector<Point3D> boundary = {{1, 2, 3}, {4, 5, 6}};
+
+    TestFile file("round_trip.mbin");
+    CHECK(WriteMeshFile(file.path(), mesh1, mesh2, boundary));
+    MeshData read1, read2;
+    CHECK(ReadMeshFile(file.path(), read1, read2));
+    CHECK(same_triangles(mesh1.triangles, read1.triangles));
+    CHECK(same_triangles(mesh2.triangles, read2.triangles));
+
+    const std::string bytes = file.read();
+    CHECK(bytes.size() >= sizeof(BinaryMeshHeader));
+    if (bytes.size() < sizeof(BinaryMeshHeader)) return;
+    BinaryMeshHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    CHECK(std::memcmp(header.magic, kBinaryMeshMagic, sizeof(kBinaryMeshMagic)) == 0);
+    // 条带上 50 段共 51 * 2 个不同的顶点
+    CHECK_EQ(header.meshes[0].vertex_count, 102u);
+    CHECK_EQ(header.meshes[0].triangle_count, 100u);
+    CHECK_EQ(header.meshes[1].triangle_count, 41u);
+    CHECK_EQ(header.boundary_count, 2u);
+    CHECK_EQ(header.boundary_offset + 2 * sizeof(Point3D), bytes.size());
+    CHECK(header.boundary_offset % 8 == 0);
+    if (header.boundary_offset + 2 * sizeof(Point3D) == bytes.size()) {
+        std::vector<Point3D> read_boundary(2);
+        std::memcpy(read_boundary.data(), bytes.data() + header.boundary_offset, 2 * sizeof(Point3D));
+        CHECK(same_points(read_boundary, boundary));
+    }
+}
+
+void test_buffers_keep_indices() {
+    const MeshData mesh1 = make_strip(0.5, 50);
+    const MeshData mesh2 = make_strip(-2.0, 20);
+    std::string bytes;
+    EncodeMeshDataBinary(mesh1, mesh2, {{1, 2, 3}}, bytes);
+
+    // 索引数据原样读入，不展开为三角形
+    MeshBuffers buffers1, buffers2;
+    std::string error;
+    CHECK(DecodeMeshBuffersBinary(bytes.data(), bytes.size(), buffers1, buffers2, error));
+    CHECK_EQ(buffers1.x.size(), 102u);
+    CHECK_EQ(buffers1.indices.size(), 300u);
+    CHECK_EQ(buffers2.x.size(), 42u);
+    MeshData expanded1, expanded2;
+    AppendBufferTriangles(buffers1, expanded1);
+    AppendBufferTriangles(buffers2, expanded2);
+    CHECK(same_triangles(expanded1.triangles, mesh1.triangles));
+    CHECK(same_triangles(expanded2.triangles, mesh2.triangles));
+
+    // 缓冲区直接写出，与由三角形合并顶点后写出的字节相同
+    PointBuffers boundary;
+    boundary.x = {1};
+    boundary.y = {2};
+    boundary.z = {3};
+    TestFile file("buffers.mbin");
+    CHECK(WriteMeshBuffersBinary(file.path(), buffers1, buffers2, boundary));
+    CHECK(file.read() == bytes);
+}
+
+void test_empty_meshes() {
+    std::string bytes;
+    EncodeMeshDataBinary(MeshData(), MeshData(), {}, bytes);
+    CHECK_EQ(bytes.size(), sizeof(BinaryMeshHeader));
+    MeshData mesh1, mesh2;
+    std::string error;
+    CHECK(DecodeMeshDataBinary(bytes.data(), bytes.size(), mesh1, mesh2, error));
+    CHECK(mesh1.triangles.empty() && mesh2.triangles.empty());
+}
+
+void test_rejects_corrupt_files() {
+    std::string bytes;
+    EncodeMeshDataBinary(make_strip(0, 10), make_strip(1, 10), {}, bytes);
+    MeshData mesh1, mesh2;
+    std::string error;
+    CHECK(DecodeMeshDataBinary(bytes.data(), bytes.size(), mesh1, mesh2, error));
+
+    // 截断
+    mesh1.triangles.clear();
+    mesh2.triangles.clear();
+    CHECK(!DecodeMeshDataBinary(bytes.data(), bytes.size() - 8, mesh1, mesh2, error));
+    CHECK(!DecodeMeshDataBinary(bytes.data(), sizeof(BinaryMeshHeader) - 1, mesh1, mesh2, error));
+
+    // 错误的 magic
+    std::string bad_magic = bytes;
+    bad_magic[0] = 'X';
+    CHECK(!DecodeMeshDataBinary(bad_magic.data(), bad_magic.size(), mesh1, mesh2, error));
+
+    // 顶点下标越界
+    BinaryMeshHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    std::string bad_index = bytes;
+    const std::uint32_t out_of_range = static_cast<std::uint32_t>(header.meshes[0].vertex_count);
+    std::memcpy(bad_index.data() + header.meshes[0].triangle_offset, &out_of_range, sizeof(out_of_range));
+    CHECK(!DecodeMeshDataBinary(bad_index.data(), bad_index.size(), mesh1, mesh2, error));
+
+    // 文本文件按扩展名走文本读取
+    TestFile text("not_binary.txt");
+    text.write("mesh1\n0 0 0\n1 0 0\n0 1 0\n");
+    MeshData text1, text2;
+    CHECK(ReadMeshFile(text.path(), text1, text2));
+    CHECK_EQ(text1.triangles.size(), 1u);
+}
+
+} // namespace
+
+int main() {
+    test_round_trip();
+    test_buffers_keep_indices();
+    test_empty_meshes();
+    test_rejects_corrupt_files();
+    return test_result();
+}
@@ -0,0 +1,120 @@
+//
+// Created by RainSure on 24-10-20.
+//
+
+#include "examples/co_refinement.h"
+#include "mesh_generators.h"
+#include "test_util.h"
+
+/**
+ * BuildMesh: 三角形列表按坐标焊接成索引网格，无法以流形方式加入的三角形按原坐标单独加入；
+ * SoA 形式的输入直接使用其中的顶点编号。
+ */
+
+namespace {
+
+std::vector<Triangle3D> make_quad(double offset = 0.0) {
+    return {Triangle3D(Point3D(0, 0, 0), Point3D(1, 0, 0), Point3D(0, 1, 0)),
+            Triangle3D(Point3D(1 + offset, 0, 0), Point3D(1, 1, 0), Point3D(0, 1 + offset, 0))};
+}
+
+void test_welds_shared_vertices() {
+    Mesh welded;
+    BuildMesh(make_quad(), welded);
+    CHECK_EQ(welded.number_of_vertices(), 4u);
+    CHECK_EQ(welded.number_of_faces(), 2u);
+    CHECK(welded.is_valid(false));
+
+    ClipOptions unwelded_options;
+    unwelded_options.weld_vertices = false;
+    Mesh unwelded;
+    BuildMesh(make_quad(), unwelded, unwelded_options);
+    CHECK_EQ(unwelded.number_of_vertices(), 6u);
+    CHECK_EQ(unwelded.number_of_faces(), 2u);
+}
+
+void test_weld_tolerance() {
+    const auto quad = make_quad(1e-9);
+    Mesh exact;
+    BuildMesh(quad, exact);
+    CHECK_EQ(exact.number_of_vertices(), 6u);
+
+    ClipOptions options;
+    options.weld_tolerance = 1e-6;
+    Mesh welded;
+    BuildMesh(quad, welded, options);
+    CHECK_EQ(welded.number_of_vertices(), 4u);
+    // 合并后的顶点取第一次出现的坐标
+    for (Vertex_index v : welded.vertices()) {
+        const Point_3& p = welded.point(v);
+        CHECK(p.x() == 0.0 || p.x() == 1.0);
+        CHECK(p.y() == 0.0 || p.y() == 1.0);
+    }
+}
+
+void test_closed_mesh_stays_closed() {
+    const auto sphere = make_sphere({0.1, 0.2, 0.3}, 1.0, 2000);
+    Mesh mesh;
+    BuildMesh(sphere, mesh);
+    CHECK_EQ(mesh.number_of_faces(), sphere.size());
+    CHECK(CGAL::is_closed(mesh));
+    CHECK(mesh.is_valid(false));
+}
+
+void test_non_manifold_fallback() {
+    // 三个三角形共用一条边，第三个无法以流形方式加入
+    std::vector<Triangle3D> fan = {Triangle3D(Point3D(0, 0, 0), Point3D(1, 0, 0), Point3D(0, 1, 0)),
+                                   Triangle3D(Point3D(1, 0, 0), Point3D(0, 0, 0), Point3D(0, -1, 0)),
+                                   Triangle3D(Point3D(0, 0, 0), Point3D(1, 0, 0), Point3D(0, 0, 1))};
+    Mesh mesh;
+    BuildMesh(fan, mesh);
+    CHECK_EQ(mesh.number_of_faces(), 3u);
+    // 焊接得到的 5 个顶点 (其中 (0, 0, 1) 没有被任何面使用) 加上单独加入的 3 个
+    CHECK_EQ(mesh.number_of_vertices(), 8u);
+    CHECK(mesh.is_valid(false));
+
+    std::vector<Triangle3D> triangles;
+    MeshToTriangles(mesh, triangles);
+    CHECK_EQ(triangles.size(), 3u);
+}
+
+void test_buffers_fallback_keeps_coordinates() {
+    // 同一个面重复多次: 除第一次外都走按原坐标单独加入的路径，顶点数组会多次重新分配
+    MeshBuffers buffers;
+    buffers.x = {0.5, 1.5, 0.5};
+    buffers.y = {-1.0, -1.0, 2.0};
+    buffers.z = {3.0, 3.0, 3.0};
+    constexpr std::size_t copies = 1000;
+    for (std::size_t i = 0; i < copies; ++i) {
+        buffers.indices.insert(buffers.indices.end(), {0, 1, 2});
+    }
+
+    Mesh mesh;
+    CHECK(BuildMesh(buffers.view(), mesh));
+    CHECK_EQ(mesh.number_of_faces(), copies);
+    CHECK_EQ(mesh.number_of_vertices(), 3 + 3 * (copies - 1));
+    bool coordinates_kept = true;
+    for (Face_index f : mesh.faces()) {
+        const auto h = mesh.halfedge(f);
+        coordinates_kept = coordinates_kept && mesh.point(mesh.target(h)) == Point_3(0.5, -1.0, 3.0) &&
+                           mesh.point(mesh.target(mesh.next(h))) == Point_3(1.5, -1.0, 3.0) &&
+                           mesh.point(mesh.target(mesh.next(mesh.next(h)))) == Point_3(0.5, 2.0, 3.0);
+    }
+    CHECK(coordinates_kept);
+
+    // 顶点编号越界
+    buffers.indices.back() = 3;
+    Mesh invalid;
+    CHECK(!BuildMesh(buffers.view(), invalid));
+}
+
+} // namespace
+
+int main() {
+    test_welds_shared_vertices();
+    test_weld_tolerance();
+    test_closed_mesh_stays_closed();
+    test_non_manifold_fallback();
+    test_buffers_fallback_keeps_coordinates();
+    return test_result();
+}
@@ -0,0 +1,63 @@
+//
+// Created by RainSure on 24-10-20.
+//
+
+#include "examples/co_refinement.h"
+#include "mesh_generators.h"
+#include "test_util.h"
+
+/**
+ * 局部共精细化 (ClipOptions::local_corefine) 与整体共精细化的裁剪结果一致:
+ * 两个网格的面数、交线上的点以及裁剪后 mesh2 的面积都相同。
+ */
+
+namespace {
+
+double total_area(const std::vector<Triangle3D>& triangles) {
+    double area = 0.0;
+    for (const auto& triangle : triangles) {
+        const auto& p = triangle.points;
+        const double ux = p[1].x - p[0].x, uy = p[1].y - p[0].y, uz = p[1].z - p[0].z;
+        const double vx = p[2].x - p[0].x, vy = p[2].y - p[0].y, vz = p[2].z - p[0].z;
+        const double cx = uy * vz - uz * vy, cy = uz * vx - ux * vz, cz = ux * vy - uy * vx;
+        area += 0.5 * std::sqrt(cx * cx + cy * cy + cz * cz);
+    }
+    return area;
+}
+
+struct ClipResult {
+    std::vector<Triangle3D> mesh1;
+    std::vector<Triangle3D> mesh2;
+    std::vector<Point3D> boundary_points;
+};
+
+ClipResult clip(const std::vector<Triangle3D>& cutter, const std::vector<Triangle3D>& target, bool local) {
+    ClipOptions options;
+    options.local_corefine = local;
+    ClipResult result{cutter, target, {}};
+    result.boundary_points = sorted_points(ClipMesh(result.mesh1, result.mesh2, options));
+    return result;
+}
+
+void check_equivalent(const std::vector<Triangle3D>& cutter, const std::vector<Triangle3D>& target) {
+    const ClipResult global = clip(cutter, target, false);
+    const ClipResult local = clip(cutter, target, true);
+    CHECK(!global.boundary_points.empty());
+    CHECK_EQ(local.mesh1.size(), global.mesh1.size());
+    CHECK_EQ(local.mesh2.size(), global.mesh2.size());
+    CHECK(same_points(local.boundary_points, global.boundary_points));
+    const double area = total_area(global.mesh2);
+    // 裁剪体内的部分被删除
+    CHECK(area < total_area(target));
+    CHECK(std::abs(total_area(local.mesh2) - area) <= 1e-9 * area);
+}
+
+} // namespace
+
+int main() {
+    // 地形穿过球，球内的部分被删除
+    check_equivalent(make_sphere({0.05, 0.03, 0.02}, 1.0, 4000), make_terrain(2.0, 8000));
+    // 圆锥穿过平面，只有一小部分面参与局部共精细化
+    check_equivalent(make_cone({0.1, -0.07, -0.8}, 0.9, 2.3, 2000), make_plane(4.0, 20000));
+    return test_result();
+}
@@ -0,0 +1,129 @@
+//
+// Created by RainSure on 24-10-20.
+//
+
+#include <charconv>
+#include <random>
+#include "examples/mesh_data.h"
+#include "test_util.h"
+
+/**
+ * 文本格式的读写: 分段并行的 from_chars 解析与单线程结果、sscanf 语义一致，
+ * MeshDataStream 与 ReadMeshData 结果一致，to_chars 输出与 operator<< 的默认格式一致。
+ */
+
+namespace {
+
+void append_shortest(std::string& text, double value) {
+    char digits[64];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    text.append(digits, result.ptr);
+}
+
+void test_parse_whitespace_and_markers() {
+    TestFile file("markers.txt");
+    file.write("  mesh1 \r\n"
+               "0 0 0\n"
+               "\t+1.5 2e-3   -3\r\n"
+               "\n"
+               ".25 -0 1E+2\n"
+               "mesh2\n"
+               "1 2 3\n"
+               "4 5 6\n"
+               "7 8 9");
+    MeshData mesh1, mesh2;
+    CHECK(ReadMeshData(file.path(), mesh1, mesh2));
+    CHECK_EQ(mesh1.triangles.size(), 1u);
+    CHECK_EQ(mesh2.triangles.size(), 1u);
+    if (mesh1.triangles.size() != 1 || mesh2.triangles.size() != 1) return;
+    CHECK(same_point(mesh1.triangles[0].points[1], Point3D(1.5, 2e-3, -3)));
+    CHECK(same_point(mesh1.triangles[0].points[2], Point3D(0.25, -0.0, 100)));
+    CHECK(same_point(mesh2.triangles[0].points[2], Point3D(7, 8, 9)));
+}
+
+void test_parse_invalid_line() {
+    TestFile file("invalid.txt");
+    file.write("mesh1\n0 0 0\n1 x 0\n0 1 0\n");
+    MeshData mesh1, mesh2;
+    CHECK(!ReadMeshData(file.path(), mesh1, mesh2));
+}
+
+void test_parallel_matches_single_thread() {
+    // 数 MB 的输入，保证按多段解析，段边界落在任意行的中间
+    std::mt19937_64 random(7);
+    std::uniform_real_distribution<double> coordinate(-1000.0, 1000.0);
+    std::vector<Point3D> points(3 * 60000);
+    std::string text = "mesh1\n";
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        if (i == points.size() / 3 * 2) text += "mesh2\n";
+        points[i] = Point3D(coordinate(random), coordinate(random), coordinate(random));
+        append_shortest(text, points[i].x);
+        text += ' ';
+        append_shortest(text, points[i].y);
+        text += ' ';
+        append_shortest(text, points[i].z);
+        text += '\n';
+    }
+    TestFile file("parallel.txt");
+    file.write(text);
+
+    MeshData single1, single2, parallel1, parallel2;
+    CHECK(ReadMeshData(file.path(), single1, single2, 1));
+    CHECK(ReadMeshData(file.path(), parallel1, parallel2, 4));
+    CHECK(same_triangles(single1.triangles, parallel1.triangles));
+    CHECK(same_triangles(single2.triangles, parallel2.triangles));
+    CHECK_EQ(single1.triangles.size(), 40000u);
+    CHECK_EQ(single2.triangles.size(), 20000u);
+
+    // 最短表示可以精确还原
+    bool exact = single1.triangles.size() == 40000;
+    for (std::size_t t = 0; exact && t < single1.triangles.size(); ++t) {
+        for (int k = 0; k < 3; ++k) {
+            exact = exact && same_point(single1.triangles[t].points[k], points[3 * t + k]);
+        }
+    }
+    CHECK(exact);
+
+    // 按小块顺序读取得到同样的结果
+    MeshDataStream stream(file.path(), 4096);
+    MeshData streamed1, streamed2;
+    while (stream.next(streamed1, streamed2)) {
+    }
+    CHECK(!stream.failed());
+    CHECK(same_triangles(single1.triangles, streamed1.triangles));
+    CHECK(same_triangles(single2.triangles, streamed2.triangles));
+}
+
+void test_writer_matches_stream_format() {
+    const std::vector<Point3D> samples = {
+            {0, -0.0, 1}, {0.1, 1.0 / 3.0, -2.5e-7}, {123456789.0, 1e21, -1e-300}, {1e100, 0.000123456789, 42.4242424}};
+    MeshData mesh1, mesh2;
+    mesh1.triangles.emplace_back(samples[0], samples[1], samples[2]);
+    mesh2.triangles.emplace_back(samples[3], samples[2], samples[1]);
+    const std::vector<Point3D> boundary = {samples[1], samples[3]};
+
+    std::ostringstream expected;
+    auto write_point = [&expected](const Point3D& p) {
+        expected << p.x << ", " << p.y << ", " << p.z << "\n";
+    };
+    expected << "mesh1:\n";
+    for (const auto& p : mesh1.triangles[0].points) write_point(p);
+    expected << "mesh2:\n";
+    for (const auto& p : mesh2.triangles[0].points) write_point(p);
+    expected << "boundary_points:\n";
+    for (const auto& p : boundary) write_point(p);
+
+    TestFile file("written.txt");
+    WriteMeshData(file.path(), mesh1, mesh2, boundary);
+    CHECK_EQ(file.read(), expected.str());
+}
+
+} // namespace
+
+int main() {
+    test_parse_whitespace_and_markers();
+    test_parse_invalid_line();
+    test_parallel_matches_single_thread();
+    test_writer_matches_stream_format();
+    return test_result();
+}
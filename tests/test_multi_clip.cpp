@@ -0,0 +1,59 @@
+//
+// Created by RainSure on 24-10-20.
+//
+
+#include "examples/multi_clip.h"
+#include "mesh_generators.h"
+#include "test_util.h"
+
+/**
+ * 多裁剪体裁剪: 两个相交的球同时裁剪地形，每个裁剪体的交线点都在裁剪后的 mesh2 上，
+ * 不落在另一个裁剪体内部。
+ */
+
+namespace {
+
+void test_boundary_points_outside_other_cutters() {
+    const std::vector<std::vector<Triangle3D>> spheres = {make_sphere({-0.3, 0.02, 0.01}, 0.8, 2000),
+                                                          make_sphere({0.4, -0.03, 0.02}, 0.7, 2000)};
+    std::vector<std::vector<Triangle3D>> cutters = spheres;
+    std::vector<Triangle3D> mesh2 = make_terrain(2.0, 8000);
+    std::vector<std::vector<Point3D>> boundary_points;
+    CHECK(ClipMeshMulti(cutters, mesh2, boundary_points));
+    CHECK_EQ(boundary_points.size(), 2u);
+    if (boundary_points.size() != 2) return;
+
+    std::vector<Point3D> vertices;
+    for (const auto& triangle : mesh2) {
+        vertices.insert(vertices.end(), triangle.points.begin(), triangle.points.end());
+    }
+    vertices = sorted_points(vertices);
+    auto on_mesh2 = [&vertices](const Point3D& p) {
+        return std::binary_search(vertices.begin(), vertices.end(), p, [](const Point3D& a, const Point3D& b) {
+            return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+        });
+    };
+
+    for (std::size_t c = 0; c < 2; ++c) {
+        CHECK(!boundary_points[c].empty());
+        Mesh other;
+        BuildMesh(spheres[1 - c], other);
+        Face_tree tree(faces(other).first, faces(other).second, other);
+        tree.build();
+        Point_inside inside(tree);
+        std::size_t inside_other = 0, missing = 0;
+        for (const auto& p : boundary_points[c]) {
+            if (inside(Point_3(p.x, p.y, p.z)) == CGAL::ON_BOUNDED_SIDE) ++inside_other;
+            if (!on_mesh2(p)) ++missing;
+        }
+        CHECK_EQ(inside_other, 0u);
+        CHECK_EQ(missing, 0u);
+    }
+}
+
+} // namespace
+
+int main() {
+    test_boundary_points_outside_other_cutters();
+    return test_result();
+}
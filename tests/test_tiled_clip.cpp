@@ -0,0 +1,176 @@
+//
+// Created by RainSure on 24-10-20.
+//
+
+#include "examples/tiled_clip.h"
+#include "mesh_generators.h"
+#include "test_util.h"
+
+/**
+ * 分块裁剪与整体裁剪 (ClipMesh) 的结果一致: 瓦片边长远小于裁剪体，大量三角形跨越瓦片边界，
+ * 两者的面数、边界点和面积相同，裁剪后 mesh2 焊接后的边界边数也相同 (接缝处没有裂缝或 T 形连接)。
+ * 瓦片变小时，单个瓦片与单个裁剪体分组同时处理的三角形数随之减少。
+ */
+
+namespace {
+
+void append_point(std::string& text, const Point3D& p) {
+    char digits[64];
+    for (double value : {p.x, p.y, p.z}) {
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        text.append(digits, result.ptr);
+        text += ' ';
+    }
+    text += '\n';
+}
+
+// 读取输出文件 ("mesh1:" / "mesh2:" / "boundary_points:" 各段，每行 "x, y, z")
+bool read_clip_output(const std::string& path, MeshData& mesh1, MeshData& mesh2, std::vector<Point3D>& boundary) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    std::string line;
+    int section = -1;
+    std::vector<Point3D> points[2];
+    while (std::getline(file, line)) {
+        if (line == "mesh1:") {
+            section = 0;
+        } else if (line == "mesh2:") {
+            section = 1;
+        } else if (line == "boundary_points:") {
+            section = 2;
+        } else if (!line.empty()) {
+            std::replace(line.begin(), line.end(), ',', ' ');
+            std::istringstream fields(line);
+            Point3D p;
+            if (section < 0 || !(fields >> p.x >> p.y >> p.z)) return false;
+            (section == 2 ? boundary : points[section]).push_back(p);
+        }
+    }
+    MeshData* meshes[2] = {&mesh1, &mesh2};
+    for (int m = 0; m < 2; ++m) {
+        if (points[m].size() % 3 != 0) return false;
+        for (std::size_t i = 0; i < points[m].size(); i += 3) {
+            meshes[m]->triangles.emplace_back(points[m][i], points[m][i + 1], points[m][i + 2]);
+        }
+    }
+    return true;
+}
+
+std::vector<Point3D> unique_points(const std::vector<Point3D>& points) {
+    std::vector<Point3D> sorted = sorted_points(points);
+    sorted.erase(std::unique(sorted.begin(), sorted.end(), same_point), sorted.end());
+    return sorted;
+}
+
+std::size_t border_edges(const std::vector<Triangle3D>& triangles) {
+    Mesh mesh;
+    BuildMesh(triangles, mesh);
+    std::size_t count = 0;
+    for (Edge_index e : mesh.edges()) {
+        if (mesh.is_border(e)) ++count;
+    }
+    return count;
+}
+
+double total_area(const std::vector<Triangle3D>& triangles) {
+    double area = 0.0;
+    for (const auto& triangle : triangles) {
+        area += std::sqrt(CGAL::to_double(K::Triangle_3(to_kernel_point<K>(triangle.points[0]), to_kernel_point<K>(triangle.points[1]),
+                                                        to_kernel_point<K>(triangle.points[2])).squared_area()));
+    }
+    return area;
+}
+
+// 球形裁剪体与穿过它的地形，写成文本输入文件
+void write_input(const TestFile& input) {
+    const auto cutter = make_sphere({0.05, 0.03, 0.02}, 1.0, 2000);
+    const auto target = make_terrain(2.0, 8000);
+    std::string text = "mesh1\n";
+    for (const auto& triangle : cutter) {
+        for (const auto& p : triangle.points) append_point(text, p);
+    }
+    text += "mesh2\n";
+    for (const auto& triangle : target) {
+        for (const auto& p : triangle.points) append_point(text, p);
+    }
+    input.write(text);
+}
+
+void test_tiled_matches_untiled(double tile_size) {
+    TestFile input("tiled_input.txt");
+    write_input(input);
+
+    // 整体裁剪，按同样的文本格式输出
+    TestFile untiled_output("untiled_output.txt");
+    {
+        MeshData mesh1, mesh2;
+        CHECK(ReadMeshData(input.path(), mesh1, mesh2));
+        const auto boundary = ClipMesh(mesh1.triangles, mesh2.triangles);
+        WriteMeshData(untiled_output.path(), mesh1, mesh2, boundary);
+    }
+
+    TestFile tiled_output("tiled_output.txt");
+    TiledClipOptions options;
+    options.tile_size = tile_size;
+    options.block_size = 4096;
+    options.temp_dir = std::filesystem::temp_directory_path().string();
+    CHECK(ClipMeshFileTiled(input.path(), tiled_output.path(), options));
+
+    MeshData untiled1, untiled2, tiled1, tiled2;
+    std::vector<Point3D> untiled_boundary, tiled_boundary;
+    CHECK(read_clip_output(untiled_output.path(), untiled1, untiled2, untiled_boundary));
+    CHECK(read_clip_output(tiled_output.path(), tiled1, tiled2, tiled_boundary));
+
+    CHECK(!untiled_boundary.empty());
+    CHECK_EQ(tiled1.triangles.size(), untiled1.triangles.size());
+    CHECK_EQ(tiled2.triangles.size(), untiled2.triangles.size());
+    CHECK(same_points(unique_points(tiled_boundary), unique_points(untiled_boundary)));
+    CHECK_EQ(border_edges(tiled2.triangles), border_edges(untiled2.triangles));
+    const double area = total_area(untiled2.triangles);
+    CHECK(std::abs(total_area(tiled2.triangles) - area) <= 1e-6 * area);
+    const double cutter_area = total_area(untiled1.triangles);
+    CHECK(std::abs(total_area(tiled1.triangles) - cutter_area) <= 1e-6 * cutter_area);
+}
+
+struct ContactStats {
+    std::uint64_t total = 0;
+    std::uint64_t max_group = 0;
+    std::uint64_t max_tile = 0;
+};
+
+ContactStats tiled_contact_stats(const TestFile& input, double tile_size) {
+    TestFile output("tiled_stats_output.txt");
+    TiledClipOptions options;
+    options.tile_size = tile_size;
+    options.block_size = 4096;
+    options.temp_dir = std::filesystem::temp_directory_path().string();
+    Stats::global().clear();
+    Stats::global().set_enabled(true);
+    CHECK(ClipMeshFileTiled(input.path(), output.path(), options));
+    Stats::global().set_enabled(false);
+    return {Stats::global().count("contact_faces"), Stats::global().count("max_group_contact_faces"), Stats::global().count("max_tile_faces")};
+}
+
+void test_contact_bounded_by_tile_size() {
+    // 瓦片越小，单个瓦片与单个分组中同时处理的三角形越少，而不是把所有交叠三角形放在一起处理
+    TestFile input("tiled_stats_input.txt");
+    write_input(input);
+    const ContactStats coarse = tiled_contact_stats(input, 1.0);
+    const ContactStats fine = tiled_contact_stats(input, 0.25);
+    CHECK(coarse.total > 0);
+    CHECK(fine.max_group < coarse.max_group);
+    CHECK(fine.max_tile < coarse.max_tile);
+    CHECK(fine.max_group * 4 <= fine.total);
+    Stats::global().clear();
+}
+
+} // namespace
+
+int main() {
+    // 瓦片边长远小于裁剪体，球面与地形的交线穿过许多瓦片边界
+    test_tiled_matches_untiled(0.3);
+    // 默认瓦片边长
+    test_tiled_matches_untiled(0.0);
+    test_contact_bounded_by_tile_size();
+    return test_result();
+}
@@ -0,0 +1,123 @@
+//
+// Created by RainSure on 24-10-20.
+//
+
+#ifndef MESH_INTERSECTION_TEST_UTIL_H
+#define MESH_INTERSECTION_TEST_UTIL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "examples/mesh_data.h"
+
+/**
+ * 回归测试使用的最小工具: CHECK 失败时打印位置并计数，main 以 test_result() 作为退出码。
+ * 每个测试文件是一个独立的可执行程序，由 ctest 运行。
+ */
+
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                      \
+    do {                                                                                      \
+        if (!(condition)) {                                                                   \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #condition << std::endl; \
+            ++test_failures();                                                                \
+        }                                                                                     \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                         \
+    do {                                                                                                   \
+        const auto& actual_value_ = (actual);                                                              \
+        const auto& expected_value_ = (expected);                                                          \
+        if (!(actual_value_ == expected_value_)) {                                                         \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ failed: " #actual " == " #expected    \
+                      << " (" << actual_value_ << " vs " << expected_value_ << ")" << std::endl;          \
+            ++test_failures();                                                                             \
+        }                                                                                                  \
+    } while (0)
+
+inline int test_result() {
+    if (test_failures() == 0) {
+        std::cerr << "All checks passed." << std::endl;
+        return 0;
+    }
+    std::cerr << test_failures() << " check(s) failed." << std::endl;
+    return 1;
+}
+
+// 临时目录下的文件路径，析构时删除文件
+class TestFile {
+public:
+    explicit TestFile(const std::string& name) {
+        static std::atomic<unsigned> counter{0};
+        const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+        path_ = (std::filesystem::temp_directory_path() /
+                 ("mesh_intersection_test_" + std::to_string(stamp) + "_" + std::to_string(counter++) + "_" + name)).string();
+    }
+    ~TestFile() {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+    TestFile(const TestFile&) = delete;
+    TestFile& operator=(const TestFile&) = delete;
+
+    const std::string& path() const { return path_; }
+
+    void write(const std::string& content) const {
+        std::ofstream file(path_, std::ios::binary);
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+
+    std::string read() const {
+        std::ifstream file(path_, std::ios::binary);
+        std::ostringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+private:
+    std::string path_;
+};
+
+inline bool same_point(const Point3D& a, const Point3D& b) {
+    return std::memcmp(&a, &b, sizeof(Point3D)) == 0;
+}
+
+inline bool same_triangles(const std::vector<Triangle3D>& a, const std::vector<Triangle3D>& b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        for (int k = 0; k < 3; ++k) {
+            if (!same_point(a[i].points[k], b[i].points[k])) return false;
+        }
+    }
+    return true;
+}
+
+// 按坐标排序，用于比较与顺序无关的点集
+inline std::vector<Point3D> sorted_points(std::vector<Point3D> points) {
+    std::sort(points.begin(), points.end(), [](const Point3D& a, const Point3D& b) {
+        return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+    });
+    return points;
+}
+
+inline bool same_points(const std::vector<Point3D>& a, const std::vector<Point3D>& b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (!same_point(a[i], b[i])) return false;
+    }
+    return true;
+}
+
+#endif //MESH_INTERSECTION_TEST_UTIL_H